@@ -0,0 +1,124 @@
+# helpers shared by the compile time benchmarks
+import json
+import os
+import re
+import subprocess
+import tempfile
+import time
+
+
+class CompileResult:
+    def __init__(self, ok, seconds, max_rss_kb, output, trace):
+        self.ok = ok
+        self.seconds = seconds
+        self.max_rss_kb = max_rss_kb
+        self.output = output
+        self.trace = trace
+
+
+def is_clang(cxx):
+    out = subprocess.run([cxx, "--version"], capture_output=True, text=True).stdout
+    return "clang" in out
+
+
+def compile_source(cxx, source, flags, include_dirs, time_trace=False, time_report=False, output=None):
+    """compile $source (a string) and return a @CompileResult, the object is kept at $output if given"""
+    with tempfile.TemporaryDirectory() as tmp:
+        src = os.path.join(tmp, "bench.cpp")
+        obj = output or os.path.join(tmp, "bench.o")
+        with open(src, "w") as f:
+            f.write(source)
+
+        cmd = [cxx, "-c", src, "-o", obj] + list(flags)
+        cmd += ["-I" + d for d in include_dirs]
+        if time_trace:
+            cmd.append("-ftime-trace")
+        if time_report:
+            cmd.append("-ftime-report")
+
+        begin = time.perf_counter()
+        proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+        output = proc.stdout.read()
+        _, status, usage = os.wait4(proc.pid, 0)
+        seconds = time.perf_counter() - begin
+        proc.returncode = os.waitstatus_to_exitcode(status)
+
+        trace = None
+        trace_file = os.path.join(tmp, "bench.json")
+        if time_trace and os.path.exists(trace_file):
+            with open(trace_file) as f:
+                trace = json.load(f)
+
+        return CompileResult(proc.returncode == 0, seconds, usage.ru_maxrss, output, trace)
+
+
+def trace_totals(trace):
+    """sum clang -ftime-trace events, return {name: (count, total_ms)}"""
+    totals = {}
+    if trace is None:
+        return totals
+    for event in trace.get("traceEvents", []):
+        if event.get("ph") != "X":
+            continue
+        name = event.get("name", "")
+        if name.startswith("Total "):
+            continue
+        count, ms = totals.get(name, (0, 0.0))
+        totals[name] = (count + 1, ms + event.get("dur", 0) / 1000.0)
+    return totals
+
+
+def trace_phase_totals(trace):
+    """clang -ftime-trace "Total ..." events, return {name: total_ms}"""
+    totals = {}
+    if trace is None:
+        return totals
+    for event in trace.get("traceEvents", []):
+        name = event.get("name", "")
+        if event.get("ph") == "X" and name.startswith("Total "):
+            totals[name[len("Total "):]] = event.get("dur", 0) / 1000.0
+    return totals
+
+
+def gcc_time_report(output):
+    """parse gcc -ftime-report, return {name: wall_ms}"""
+    totals = {}
+    for line in output.splitlines():
+        if ":" not in line:
+            continue
+        name, _, values = line.partition(":")
+        name = name.strip().lstrip("|")
+        # usr (x%) sys (x%) wall (x%) ggc (x%)
+        columns = re.findall(r"([\d.]+)\s*\(\s*\d+%\)", values)
+        if len(columns) < 3:
+            continue
+        totals[name] = float(columns[2]) * 1000.0
+    return totals
+
+
+def gcc_time_report_ggc(output):
+    """parse gcc -ftime-report, return {name: ggc_kb}, the memory gcc allocated in each phase"""
+    totals = {}
+    for line in output.splitlines():
+        if ":" not in line:
+            continue
+        name, _, values = line.partition(":")
+        name = name.strip().lstrip("|")
+        match = re.search(r"(\d+)([kM]?)\s*\(\s*\d+%\)\s*$", values)
+        if match is None:
+            continue
+        scale = {"": 1.0 / 1024, "k": 1.0, "M": 1024.0}[match.group(2)]
+        totals[name] = int(match.group(1)) * scale
+    return totals
+
+
+def print_table(header, rows):
+    widths = [len(h) for h in header]
+    for row in rows:
+        for i, cell in enumerate(row):
+            widths[i] = max(widths[i], len(str(cell)))
+    line = "| " + " | ".join(h.ljust(w) for h, w in zip(header, widths)) + " |"
+    print(line)
+    print("|" + "|".join("-" * (w + 2) for w in widths) + "|")
+    for row in rows:
+        print("| " + " | ".join(str(c).ljust(w) for c, w in zip(row, widths)) + " |")
@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+# compile time and compiler memory of synthetic Config trees
+#
+#   N: number of interfaces in the config
+#   M: number of endpoints in each interface
+#   D: nesting depth of the tree below the config
+#      1 Config > Interface > Endpoint
+#      2 Config > InterfaceAssociation > Interface > Endpoint
+#      3 like 2, and every endpoint holds a class specific CustomDesc
+#
+# every compiler given by --cxx is measured, the template instantiation and
+# constant evaluation totals come from -ftime-trace (clang) or -ftime-report (gcc).
+# --csv appends the rows to a file so the numbers can be tracked across releases
+import argparse
+import csv
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import benchlib
+
+
+def make_endpoint(address, depth):
+    custom = ""
+    if depth >= 3:
+        custom = ",\n            CustomDesc{std::array{8, 0x25, 0x01, 0, 0, 0, 0, 0}}"
+    return "Endpoint{\n            BulkInitPack{0x%02x, 512, 0}%s\n        }" % (address, custom)
+
+
+def make_interface(no, num_endpoint, depth):
+    endpoints = []
+    for i in range(num_endpoint):
+        # keep every address in 1..15, alternate OUT/IN
+        number = (no * num_endpoint + i) // 2 % 15 + 1
+        direction = 0x80 if i % 2 else 0
+        endpoints.append(make_endpoint(number | direction, depth))
+    body = ",\n        ".join(["InterfaceInitPack{%d, 0, 0xff, 0, 0, 0}" % no] + endpoints)
+    return "Interface{\n        %s\n    }" % body
+
+
+def make_source(num_interface, num_endpoint, depth):
+    children = []
+    for no in range(num_interface):
+        interface = make_interface(no, num_endpoint, depth)
+        if depth >= 2:
+            interface = "InterfaceAssociation{\n    InterfaceAssociationInitPack{0xff, 0, 0, 0},\n    %s\n}" % interface
+        children.append(interface)
+
+    lines = [
+        '#include "tpusb/usb.hpp"',
+        "",
+        "static constexpr auto config = Config{",
+        "ConfigInitPack{1, 0, 0x80, 250},",
+        ",\n".join(children),
+        "};",
+        "static_assert(config.char_array[IConfig::num_interface_offset] == %d);" % num_interface,
+        'extern "C" const uint8_t* bench_descriptor = config.char_array.desc;',
+    ]
+    return "\n".join(lines) + "\n"
+
+
+def total_length(num_interface, num_endpoint, depth):
+    endpoint = 7 + (8 if depth >= 3 else 0)
+    interface = 9 + num_endpoint * endpoint + (8 if depth >= 2 else 0)
+    return 9 + num_interface * interface
+
+
+def parse_list(text):
+    return [int(x) for x in text.split(",")]
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--cxx", action="append", default=[])
+    parser.add_argument("--include", required=True)
+    parser.add_argument("--interfaces", default="1,4,8,16,30")
+    parser.add_argument("--endpoints", default="2")
+    parser.add_argument("--depths", default="1,2,3")
+    parser.add_argument("--std", default="c++17")
+    parser.add_argument("--csv", help="append the results to this file")
+    parser.add_argument("--tag", default="", help="label of this run in the csv, eg. a release")
+    args = parser.parse_args()
+
+    compilers = args.cxx or ["c++"]
+    header = ["compiler", "N", "M", "D", "bytes", "wall (s)", "peak rss (kB)", "instantiation (ms)", "constexpr (ms)"]
+    rows = []
+    failed = False
+    for cxx in compilers:
+        clang = benchlib.is_clang(cxx)
+        flags = ["-std=" + args.std, "-O0"]
+        for depth in parse_list(args.depths):
+            for num_interface in parse_list(args.interfaces):
+                for num_endpoint in parse_list(args.endpoints):
+                    source = make_source(num_interface, num_endpoint, depth)
+                    res = benchlib.compile_source(
+                        cxx, source, flags, [args.include],
+                        time_trace=clang, time_report=not clang
+                    )
+                    if not res.ok:
+                        print("\n".join(res.output.splitlines()[:20]))
+                        failed = True
+
+                    if clang:
+                        totals = benchlib.trace_phase_totals(res.trace)
+                        instantiation = totals.get("InstantiateClass", 0) + totals.get("InstantiateFunction", 0)
+                        constexpr = totals.get("ConstantEvaluation", 0)
+                    else:
+                        totals = benchlib.gcc_time_report(res.output)
+                        instantiation = totals.get("template instantiation", 0)
+                        constexpr = totals.get("constant expression evaluation", 0)
+
+                    size = total_length(num_interface, num_endpoint, depth)
+                    rows.append([
+                        os.path.basename(cxx),
+                        num_interface,
+                        num_endpoint,
+                        depth,
+                        size,
+                        "%.3f" % res.seconds,
+                        res.max_rss_kb,
+                        "%.0f" % instantiation,
+                        "%.0f" % constexpr,
+                    ])
+
+    benchlib.print_table(header, rows)
+
+    if args.csv:
+        new_file = not os.path.exists(args.csv)
+        with open(args.csv, "a", newline="") as f:
+            writer = csv.writer(f)
+            if new_file:
+                writer.writerow(["tag"] + header)
+            for row in rows:
+                writer.writerow([args.tag] + row)
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
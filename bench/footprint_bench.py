@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+# flash and ram footprint of the descriptor objects
+#
+# every example is compiled at -Os together with a few lines forcing the
+# descriptor objects and the hand-written reference arrays to be emitted,
+# then objdump tells the section and size of each one.
+# the run fails when a template object takes more bytes than its reference,
+# or more bytes than recorded in footprint_baseline.json (--update-baseline rewrites it),
+# and when an object or its reference is not in the object file at all
+# the descriptors are data, the TU emits no code to report as .text
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import benchlib
+import config_bench
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+BASELINE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "footprint_baseline.json")
+
+# example -> [(template object, reference array)]
+# a reference of None means the object must not be larger than its descriptor length
+CASES = {
+    "ch32-uac": ("example/ch32-uac.cpp", [
+        ("test", "MyCfgDescr_HS"),
+    ]),
+    "ch32-hid": ("example/ch32-hid.cpp", [
+        ("hid", "MyCfgDescr_HS"),
+        ("hid_config_descriptor", "MyCfgDescr_HS"),
+    ]),
+    "midiv1": ("example/midiv1.cpp", [
+        ("config", "USBD_MIDI_CfgDesc"),
+    ]),
+    "usb_str": ("example/usb_str.cpp", [
+        ("str1", "MyManuInfo"),
+        ("str2", "MyProdInfo"),
+        ("str3", "MySerNumInfo"),
+        ("str4", "MyNoteInfo"),
+    ]),
+}
+
+SYNTHETIC = [
+    # N interfaces, M endpoints, depth D, see config_bench.py
+    (8, 2, 2),
+    (30, 2, 3),
+]
+
+def keep_alive(names):
+    lines = ["", "// footprint_bench: keep the objects in the object file"]
+    for i, name in enumerate(names):
+        lines.append('extern "C" const void* const tpusb_footprint_%d = &%s;' % (i, name))
+    return "\n".join(lines) + "\n"
+
+
+# objdump -t: address, 7 flag characters, section, size, name
+SYMBOL = re.compile(r"^[0-9a-fA-F]+ (.{7}) (\S+)\s+([0-9a-fA-F]+) (.+)$")
+
+
+def symbols(objdump, obj):
+    """{name: (section, size)} of the objects defined in $obj, the section as named in the object file"""
+    out = subprocess.run([objdump, "-t", "-C", obj], capture_output=True, text=True, check=True).stdout
+    result = {}
+    for line in out.splitlines():
+        match = SYMBOL.match(line)
+        if match is None:
+            continue
+        flags, section, size, name = match.groups()
+        if "O" not in flags or section == "*UND*":
+            continue
+        result[name.strip()] = (section, int(size, 16))
+    return result
+
+
+def measure(args, source, names):
+    with tempfile.TemporaryDirectory() as tmp:
+        obj = os.path.join(tmp, "footprint.o")
+        res = benchlib.compile_source(
+            args.cxx, source + keep_alive(names),
+            ["-std=" + args.std, "-Os"], [ROOT, os.path.join(ROOT, "include"), os.path.join(ROOT, "example")],
+            output=obj
+        )
+        if not res.ok:
+            print("\n".join(res.output.splitlines()[:20]))
+            return None
+        return symbols(args.objdump, obj)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--cxx", default="c++")
+    parser.add_argument("--objdump", default="objdump")
+    parser.add_argument("--std", default="c++17")
+    parser.add_argument("--update-baseline", action="store_true")
+    args = parser.parse_args()
+
+    baseline = {}
+    if os.path.exists(BASELINE):
+        with open(BASELINE) as f:
+            baseline = json.load(f)
+
+    rows = []
+    current = {}
+    failures = []
+
+    def check(key, obj_section, obj_size, ref, ref_size):
+        current[key] = obj_size
+        status = "ok"
+        if obj_section is None:
+            status = "missing"
+        elif ref_size is None:
+            status = "reference missing"
+        elif obj_size > ref_size:
+            status = "larger than reference"
+        elif key in baseline and obj_size > baseline[key]:
+            status = "larger than baseline %d" % baseline[key]
+        if status != "ok":
+            failures.append(key)
+        rows.append([key, obj_section or "-", obj_size, ref, "-" if ref_size is None else ref_size, status])
+
+    for case, (path, pairs) in CASES.items():
+        with open(os.path.join(ROOT, path)) as f:
+            source = f.read()
+        names = [n for pair in pairs for n in pair if n]
+        syms = measure(args, source, names)
+        if syms is None:
+            failures.append(case)
+            continue
+        for obj, ref in pairs:
+            obj_section, obj_size = syms.get(obj, (None, 0))
+            _, ref_size = syms.get(ref, (None, None))
+            check("%s/%s" % (case, obj), obj_section, obj_size, ref, ref_size)
+
+    for n, m, d in SYNTHETIC:
+        source = config_bench.make_source(n, m, d)
+        syms = measure(args, source, ["config"])
+        case = "synthetic-n%d-m%d-d%d" % (n, m, d)
+        if syms is None:
+            failures.append(case)
+            continue
+        obj_section, obj_size = syms.get("config", (None, 0))
+        check(case + "/config", obj_section, obj_size, "wTotalLength", config_bench.total_length(n, m, d))
+
+    benchlib.print_table(["object", "section", "bytes", "reference", "reference bytes", "status"], rows)
+
+    if args.update_baseline:
+        with open(BASELINE, "w") as f:
+            json.dump(current, f, indent=4, sort_keys=True)
+            f.write("\n")
+        print("baseline written to %s" % BASELINE)
+        return 0
+
+    if failures:
+        print("footprint regression: " + ", ".join(failures))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+# compile time of USB_STR versus the string length
+#
+# every row compiles a TU with $count strings of the given length,
+# the strings are compiled again with a tiny -ftemplate-depth to show
+# the instantiation depth does not grow with the length.
+# with clang the instantiation count is read from -ftime-trace,
+# with gcc the template instantiation time and memory from -ftime-report,
+# the memory is exact, so it shows the cost per string even when the time is below the 10ms resolution
+import argparse
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import benchlib
+
+LENGTHS = [8, 16, 32, 64, 126]
+
+
+def make_source(length, count):
+    lines = ['#include "tpusb/usb_str.hpp"', ""]
+    for i in range(count):
+        # mix in a 2-byte and a 4-byte character, $length utf16 code units in total
+        text = ("s%d-" % i + "x" * length)[:length - 3] + "\\u00e9\\U0001F3B5"
+        lines.append('static constexpr auto str%d = USB_STR(u8"%s");' % (i, text))
+        lines.append("static_assert(str%d.len == %d);" % (i, length * 2 + 2))
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--cxx", default="c++")
+    parser.add_argument("--include", required=True)
+    parser.add_argument("--count", type=int, default=32)
+    parser.add_argument("--std", default="c++17")
+    args = parser.parse_args()
+
+    clang = benchlib.is_clang(args.cxx)
+    flags = ["-std=" + args.std, "-fsyntax-only" if not clang else "-O0"]
+    rows = []
+    failed = False
+    # the header alone, subtracted to get the memory of one string
+    base_kb = 0.0
+    if not clang:
+        base = benchlib.compile_source(args.cxx, make_source(8, 0), flags, [args.include], time_report=True)
+        base_kb = benchlib.gcc_time_report_ggc(base.output).get("template instantiation", 0.0)
+    for length in LENGTHS:
+        source = make_source(length, args.count)
+        res = benchlib.compile_source(args.cxx, source, flags, [args.include], time_trace=clang, time_report=not clang)
+        shallow = benchlib.compile_source(args.cxx, source, flags + ["-ftemplate-depth=8"], [args.include])
+        if not res.ok:
+            print("\n".join(res.output.splitlines()[:20]))
+            failed = True
+
+        instantiations = "n/a"
+        template_ms = 0.0
+        template_kb = "n/a"
+        per_string_kb = "n/a"
+        if clang:
+            totals = benchlib.trace_totals(res.trace)
+            instantiations = sum(totals.get(k, (0, 0))[0] for k in ("InstantiateFunction", "InstantiateClass"))
+            template_ms = sum(totals.get(k, (0, 0.0))[1] for k in ("InstantiateFunction", "InstantiateClass"))
+        else:
+            template_ms = benchlib.gcc_time_report(res.output).get("template instantiation", 0.0)
+            kb = benchlib.gcc_time_report_ggc(res.output).get("template instantiation", 0.0)
+            template_kb = "%.0f" % kb
+            per_string_kb = "%.1f" % ((kb - base_kb) / args.count)
+        rows.append([
+            length,
+            args.count,
+            "%.3f" % res.seconds,
+            res.max_rss_kb,
+            instantiations,
+            "%.0f" % template_ms,
+            template_kb,
+            per_string_kb,
+            "ok" if shallow.ok else "fail",
+        ])
+
+    benchlib.print_table(
+        ["length", "strings", "wall (s)", "peak rss (kB)", "instantiations",
+         "template (ms)", "template memory (kB)", "per string (kB)", "-ftemplate-depth=8"],
+        rows
+    )
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
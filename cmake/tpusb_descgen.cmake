@@ -0,0 +1,82 @@
+# host side descriptor codegen, see include/tpusb/descgen.hpp
+#
+# tpusb_generate_descriptor(<name>
+#     SOURCE <descriptor.cpp>
+#     [OUTPUT_DIR <dir>]
+#     [INCLUDE_DIRECTORIES <dir>...]
+# )
+# builds <descriptor.cpp> with the host compiler into a small program which writes
+# <name>.c, <name>.h and <name>.json (layout map, see tpusb/layout.hpp) into
+# OUTPUT_DIR (default ${CMAKE_CURRENT_BINARY_DIR}/tpusb),
+# they are only regenerated when the descriptor source or a header it includes changes.
+# a static library <name> holding the generated bytes is added for the firmware to link
+#
+# the host compiler is TPUSB_HOST_CXX, or the project compiler when not cross compiling
+
+set(TPUSB_DIR ${CMAKE_CURRENT_LIST_DIR}/..)
+# the paths of a DEPFILE are taken as they are written by the compiler
+if (POLICY CMP0116)
+    cmake_policy(SET CMP0116 NEW)
+endif()
+set(TPUSB_HOST_CXX "" CACHE STRING "host c++ compiler of the descriptor codegen, gcc or clang compatible")
+
+function(tpusb_generate_descriptor name)
+    cmake_parse_arguments(ARG "" "SOURCE;OUTPUT_DIR" "INCLUDE_DIRECTORIES" ${ARGN})
+    if (NOT ARG_SOURCE)
+        message(FATAL_ERROR "tpusb_generate_descriptor(${name}) needs a SOURCE")
+    endif()
+    if (NOT ARG_OUTPUT_DIR)
+        set(ARG_OUTPUT_DIR ${CMAKE_CURRENT_BINARY_DIR}/tpusb)
+    endif()
+
+    set(host_cxx ${TPUSB_HOST_CXX})
+    if (NOT host_cxx)
+        if (CMAKE_CROSSCOMPILING)
+            find_program(TPUSB_HOST_CXX_PROGRAM NAMES c++ g++ clang++)
+            set(host_cxx ${TPUSB_HOST_CXX_PROGRAM})
+        else()
+            set(host_cxx ${CMAKE_CXX_COMPILER})
+        endif()
+    endif()
+    if (NOT host_cxx)
+        message(FATAL_ERROR "no host c++ compiler for tpusb_generate_descriptor, set TPUSB_HOST_CXX")
+    endif()
+
+    get_filename_component(source ${ARG_SOURCE} ABSOLUTE)
+    set(includes -I${TPUSB_DIR}/include)
+    foreach(dir ${ARG_INCLUDE_DIRECTORIES})
+        list(APPEND includes -I${dir})
+    endforeach()
+
+    set(host_tool ${CMAKE_CURRENT_BINARY_DIR}/${name}-descgen)
+    if (CMAKE_HOST_WIN32)
+        set(host_tool ${host_tool}.exe)
+    endif()
+    file(GLOB tpusb_headers ${TPUSB_DIR}/include/tpusb/*.hpp)
+    file(MAKE_DIRECTORY ${ARG_OUTPUT_DIR})
+
+    # the compiler lists every header the descriptor source includes in a depfile,
+    # makefile generators read it since cmake 3.20, older ones fall back to the tpusb headers
+    set(host_object ${CMAKE_CURRENT_BINARY_DIR}/${name}-descgen.o)
+    set(depfile ${CMAKE_CURRENT_BINARY_DIR}/${name}-descgen.d)
+    set(depfile_args)
+    if (CMAKE_GENERATOR MATCHES "Ninja" OR NOT CMAKE_VERSION VERSION_LESS 3.20)
+        set(depfile_args DEPFILE ${depfile})
+    endif()
+
+    add_custom_command(
+        OUTPUT ${ARG_OUTPUT_DIR}/${name}.c ${ARG_OUTPUT_DIR}/${name}.h ${ARG_OUTPUT_DIR}/${name}.json
+        COMMAND ${host_cxx} -std=c++17 -DTPUSB_DESCGEN ${includes}
+            -MD -MF ${depfile} -MT ${ARG_OUTPUT_DIR}/${name}.c
+            -c ${source} -o ${host_object}
+        COMMAND ${host_cxx} -std=c++17 -DTPUSB_DESCGEN ${includes}
+            ${host_object} ${TPUSB_DIR}/tools/descgen.cpp -o ${host_tool}
+        COMMAND ${host_tool} ${ARG_OUTPUT_DIR} ${name}
+        DEPENDS ${source} ${TPUSB_DIR}/tools/descgen.cpp ${tpusb_headers}
+        ${depfile_args}
+        COMMENT "Generating descriptor ${name} from ${ARG_SOURCE}"
+        VERBATIM
+    )
+    add_library(${name} STATIC ${ARG_OUTPUT_DIR}/${name}.c)
+    target_include_directories(${name} PUBLIC ${ARG_OUTPUT_DIR})
+endfunction()
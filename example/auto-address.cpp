@@ -0,0 +1,211 @@
+#include <cstddef>
+#include <cstdint>
+#include "tpusb/usb.hpp"
+#include "tpusb/cdc.hpp"
+#include "tpusb/address.hpp"
+#include "tpusb/buffer.hpp"
+#include "comp.hpp"
+#include "ep0_host.hpp"
+
+// cdc and a vendor isochronous interface, no address written by hand
+static constexpr auto auto_config =
+Config{
+    ConfigInitPack{
+        1, 0, 0x80, 50, Speed::High, true
+    },
+    InterfaceAssociation{
+        InterfaceAssociationInitPack{
+            0, 2, 1, 0
+        },
+        CDCControlInterface{
+            InterfaceInitPackClassed{
+                0, 0, 1, 0
+            },
+            FunctionDesc{
+                0x0110
+            },
+            CDCLength{
+                0, 1
+            },
+            CDCManagement{
+                2
+            },
+            CDCInterfaceSpecify{
+                0, 1
+            },
+            Endpoint{
+                InterruptInitPack{
+                    auto_in, 8, 4
+                }
+            }
+        },
+        CDCDataInterface{
+            InterfaceInitPackClassed{
+                1, 0, 0, 0
+            },
+            Endpoint{
+                BulkInitPack{
+                    auto_out, 512, 0
+                }
+            },
+            Endpoint{
+                BulkInitPack{
+                    auto_in, 512, 0
+                }
+            }
+        }
+    },
+    Interface{
+        InterfaceInitPack{
+            2, 0, 0xff, 0, 0, 0
+        }
+    },
+    Interface{
+        InterfaceInitPack{
+            2, 1, 0xff, 0, 0, 0
+        },
+        Endpoint{
+            IsochronousInitPack{
+                auto_out, 192, 1, SynchronousType::Isochronous, IsoEpType::Data
+            }
+        },
+        Endpoint{
+            IsochronousInitPack{
+                auto_in, 4, 4, SynchronousType::None, IsoEpType::Feedback
+            }
+        }
+    },
+    Interface{
+        InterfaceInitPack{
+            2, 2, 0xff, 0, 0, 0
+        },
+        Endpoint{
+            IsochronousInitPack{
+                auto_out, 384, 1, SynchronousType::Isochronous, IsoEpType::Data
+            }
+        },
+        Endpoint{
+            IsochronousInitPack{
+                auto_in, 4, 4, SynchronousType::None, IsoEpType::Feedback
+            }
+        }
+    }
+};
+
+// every number has both directions, so IN and OUT pair up,
+// isochronous is numbered first, then bulk, then interrupt
+static constexpr auto config = AllocateEndpointAddress(auto_config);
+static_assert(EndpointAddressOf(config.char_array, 0, 0, 0) == 0x83);
+static_assert(EndpointAddressOf(config.char_array, 1, 0, 0) == 0x02);
+static_assert(EndpointAddressOf(config.char_array, 1, 0, 1) == 0x82);
+static_assert(EndpointAddressOf(config.char_array, 2, 1, 0) == 0x01);
+static_assert(EndpointAddressOf(config.char_array, 2, 1, 1) == 0x81);
+static_assert(EndpointAddressOf(config.char_array, 2, 2, 0) == 0x01);
+static_assert(EndpointAddressOf(config.char_array, 2, 2, 1) == 0x81);
+
+// a controller of 8 numbers, isochronous only on 3, 2 and 3 double buffered
+struct SmallControllerTraits : public DefaultControllerTraits {
+    static constexpr uint8_t num_endpoint = 8;
+
+    static constexpr bool Supports(uint8_t number, TransferType type, bool) {
+        return type != TransferType::Isochronous || number == 3;
+    }
+
+    static constexpr bool DoubleBuffered(uint8_t number) {
+        return number == 2 || number == 3;
+    }
+};
+
+static constexpr auto small_config = AllocateEndpointAddress<SmallControllerTraits>(auto_config);
+static_assert(EndpointAddressOf(small_config.char_array, 0, 0, 0) == 0x81);
+static_assert(EndpointAddressOf(small_config.char_array, 1, 0, 0) == 0x02);
+static_assert(EndpointAddressOf(small_config.char_array, 1, 0, 1) == 0x82);
+static_assert(EndpointAddressOf(small_config.char_array, 2, 1, 0) == 0x03);
+static_assert(EndpointAddressOf(small_config.char_array, 2, 2, 1) == 0x83);
+
+// the same traits lay out the packet memory, only 2 and 3 are double buffered
+static constexpr auto& small_plan = buffer_plan<small_config, SmallControllerTraits>;
+static_assert(small_plan.Find(0x03).double_buffered && small_plan.Find(0x82).double_buffered);
+static_assert(!small_plan.Find(0x81).double_buffered);
+
+// the isochronous endpoint is numbered first, the bulk one of the other alternate setting shares its number
+static constexpr auto alter_config =
+Config{
+    ConfigInitPack{
+        1, 0, 0x80, 50, Speed::High, true
+    },
+    Interface{
+        InterfaceInitPack{
+            0, 0, 0xff, 0, 0, 0
+        },
+        Endpoint{
+            BulkInitPack{
+                auto_out, 512, 0
+            }
+        }
+    },
+    Interface{
+        InterfaceInitPack{
+            0, 1, 0xff, 0, 0, 0
+        },
+        Endpoint{
+            IsochronousInitPack{
+                auto_out, 192, 1, SynchronousType::Isochronous, IsoEpType::Data
+            }
+        }
+    }
+};
+static constexpr auto small_alter_config = AllocateEndpointAddress<SmallControllerTraits>(alter_config);
+static_assert(EndpointAddressOf(small_alter_config.char_array, 0, 0, 0) == 0x03);
+static_assert(EndpointAddressOf(small_alter_config.char_array, 0, 1, 0) == 0x03);
+
+// numbers 1 and 2, isochronous only on the double buffered 2
+struct TinyControllerTraits : public DefaultControllerTraits {
+    static constexpr uint8_t num_endpoint = 3;
+
+    static constexpr bool Supports(uint8_t number, TransferType type, bool) {
+        return type != TransferType::Isochronous || number == 2;
+    }
+
+    static constexpr bool DoubleBuffered(uint8_t number) {
+        return number == 2;
+    }
+};
+
+// the bulk endpoint is declared first but must not take 2
+static constexpr auto bulk_first_config =
+Config{
+    ConfigInitPack{
+        1, 0, 0x80, 50, Speed::High, true
+    },
+    Interface{
+        InterfaceInitPack{
+            0, 0, 0xff, 0, 0, 0
+        },
+        Endpoint{
+            BulkInitPack{
+                auto_out, 512, 0
+            }
+        }
+    },
+    Interface{
+        InterfaceInitPack{
+            1, 0, 0xff, 0, 0, 0
+        }
+    },
+    Interface{
+        InterfaceInitPack{
+            1, 1, 0xff, 0, 0, 0
+        },
+        Endpoint{
+            IsochronousInitPack{
+                auto_out, 192, 1, SynchronousType::Isochronous, IsoEpType::Data
+            }
+        }
+    }
+};
+static constexpr auto tiny_config = AllocateEndpointAddress<TinyControllerTraits>(bulk_first_config);
+static_assert(EndpointAddressOf(tiny_config.char_array, 0, 0, 0) == 0x01);
+static_assert(EndpointAddressOf(tiny_config.char_array, 1, 1, 0) == 0x02);
+
+static_assert(CheckEp0(MakeSource<config>(), config.char_array.desc));
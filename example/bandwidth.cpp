@@ -0,0 +1,32 @@
+#include <cstddef>
+#include <cstdint>
+#include "tpusb/bandwidth.hpp"
+#include "ch32-uac.hpp"
+
+// periodic bus time
+static_assert(periodic_bandwidth<test, Speed::High>.Fits());
+static_assert(periodic_bandwidth<test, Speed::High>.Percent() == 19);
+
+// two full speed 1023 bytes isochronous endpoints need more than a frame
+static constexpr auto fs_iso_test =
+Config{
+    ConfigInitPack{
+        1, 0, 0x80, 250, Speed::Full
+    },
+    Interface{
+        InterfaceInitPack{
+            0, 0, 0xff, 0, 0, 0
+        },
+        Endpoint{
+            IsochronousInitPack{
+                0x01, 1023, 1, SynchronousType::Isochronous, IsoEpType::Data
+            }
+        },
+        Endpoint{
+            IsochronousInitPack{
+                0x81, 1023, 1, SynchronousType::Isochronous, IsoEpType::Data
+            }
+        }
+    }
+};
+static_assert(!periodic_bandwidth<fs_iso_test, Speed::Full>.Fits());
@@ -0,0 +1,20 @@
+#include <cstddef>
+#include <cstdint>
+#include "tpusb/buffer.hpp"
+#include "ch32-uac.hpp"
+
+// packet memory plan
+struct SmallControllerTraits : public DefaultControllerTraits {
+    static constexpr size_t size = 2048;
+};
+struct LargeControllerTraits : public DefaultControllerTraits {
+    static constexpr size_t size = 8192;
+};
+static constexpr auto& plan = buffer_plan<test>;
+static_assert(plan.size == 7);
+static_assert(plan[0].address == 0x00 && plan[1].address == 0x80 && plan[1].offset == 64);
+static_assert(plan.Find(0x01).offset == 128 && plan.Find(0x01).size == 1024 && plan.Find(0x01).double_buffered);
+static_assert(plan.Find(0x83).size == 64 && !plan.Find(0x83).double_buffered);
+static_assert(plan.used == 128 + 2048 + 8 + 64 + 1024 + 1024);
+static_assert(!plan.Fits() && buffer_plan<test, LargeControllerTraits>.Fits());
+static_assert(!buffer_plan<test, SmallControllerTraits>.Fits());
@@ -1,6 +1,15 @@
 #include "tpusb/hid.hpp"
 #include "tpusb/usb.hpp"
+#include "tpusb/usb_str.hpp"
+#include "tpusb/device.hpp"
+#include "tpusb/interval.hpp"
+#include "tpusb/bandwidth.hpp"
+#include "tpusb/registry.hpp"
+#include "tpusb/patch.hpp"
 #include "comp.hpp"
+#include "ep0_host.hpp"
+
+using namespace std::chrono_literals;
 
 static constexpr auto hid =
 Config{
@@ -103,3 +112,220 @@ static constexpr uint32_t fs[] {
     cmp.diff
 };
 static_assert(cmp.diff == 0);
+
+// only the bytes go to flash
+TPUSB_FINALIZED_DESCRIPTOR(hid_config_descriptor, hid, ".rodata.usb_desc", 4);
+static_assert(sizeof(hid_config_descriptor) == sizeof(MyCfgDescr_HS));
+static constexpr auto final_cmp = Compare(MyCfgDescr_HS, hid_config_descriptor.desc);
+static_assert(final_cmp.diff == 0);
+static_assert(MakeSource<hid_config_descriptor>().data == hid_config_descriptor.desc);
+static_assert(CheckEp0(MakeSource<hid_config_descriptor>(), MyCfgDescr_HS));
+
+// no interface association, the class is left to the interfaces
+static constexpr auto hid_device = Device{
+    DeviceInitPack{
+        .vendor_id = 0x1a86,
+        .product_id = 0xfe07,
+        .bcd_device = 0x0100,
+        .manufacturer_str_id = 1,
+        .product_str_id = 2,
+        .serial_str_id = 0,
+        .bcd_usb = 0x0110,
+        .speed = Speed::Full,
+        .max_pack_size0 = 8
+    },
+    hid
+};
+static_assert(hid_device.char_array[IDevice::class_offset] == 0);
+static_assert(hid_device.char_array[IDevice::max_pack_size0_offset] == 8);
+// the qualifier keeps the declared EP0 size unless the other speed has its own
+static_assert(DeviceQualifier{hid_device}.char_array[7] == 8);
+static_assert(DeviceQualifier{hid_device, 64}.char_array[7] == 64);
+static_assert(hid_device.char_array[IDevice::num_config_offset] == 1);
+
+// bInterval of each speed, and the period the host really polls at
+static_assert(EncodeInterval(TransferType::Interrupt, Speed::High, 1ms) == 4);
+static_assert(EncodeInterval(TransferType::Interrupt, Speed::High, 3ms) == 5);
+static_assert(EncodeInterval(TransferType::Interrupt, Speed::Full, 8ms) == 8);
+static_assert(EncodeInterval(TransferType::Isochronous, Speed::Full, 1ms) == 1);
+static_assert(EncodeInterval(TransferType::Isochronous, Speed::Full, 10ms) == 4);
+static_assert(ServicePeriod(TransferType::Interrupt, Speed::High, EncodeInterval(TransferType::Interrupt, Speed::High, 3ms)) == 2ms);
+static_assert(ServicePeriod(TransferType::Isochronous, Speed::Full, 4) == 8ms);
+static_assert(ServicePeriod(TransferType::Interrupt, Speed::High, hid.char_array[9 + 9 + 9 + IEndpoint::interval_offset]) == 125us);
+
+// two 512 bytes reports every microframe
+static_assert(periodic_bandwidth<hid, Speed::High>.Fits());
+
+// the same config with the service period written as a duration
+static constexpr auto hid_125us =
+Config{
+    ConfigInitPack{
+        .config_no = 1,
+        .str_id = 0,
+        .attribute = 0x80,
+        .power = 0x23
+    },
+    HID_Interface{
+        InterfaceInitPackClassed{
+            .interface_no = 0,
+            .alter = 0,
+            .protocol = 0,
+            .str_id = 0
+        },
+        HID_Descriptor<1>{
+            HID_Descriptor_InitPack{
+                .bcd_hid = 0x0111,
+                .country_code = 0x00
+            },
+            {
+                HID_DescriptorLengthDesc{
+                    .type = 0x22,
+                    .length = 0x22
+                }
+            }
+        },
+        Endpoint{
+            InterruptInitPack{
+                .address = 1,
+                .max_pack_size = 0x200,
+                .interval = 125us
+            }
+        },
+        Endpoint{
+            InterruptInitPack{
+                .address = 0x82,
+                .max_pack_size = 0x200,
+                .interval = 125us
+            }
+        }
+    }
+};
+static_assert(Compare(MyCfgDescr_HS, hid_125us.char_array.desc).diff == 0);
+
+// the period of a pack is encoded for the speed of its config,
+// the full speed form polls at the period of the high speed one
+template<Speed SPEED>
+static constexpr auto poll_3ms = Config{
+    ConfigInitPack{
+        .config_no = 1,
+        .str_id = 0,
+        .attribute = 0x80,
+        .power = 0x23,
+        .speed = SPEED
+    },
+    Interface{
+        InterfaceInitPack{0, 0, 0xff, 0, 0, 0},
+        Endpoint{
+            InterruptInitPack{
+                .address = 0x81,
+                .max_pack_size = 64,
+                .interval = 3ms
+            }
+        }
+    }
+};
+static constexpr auto poll_3ms_dual = MakeDualSpeedConfig<poll_3ms<Speed::High>>();
+static_assert(poll_3ms<Speed::High>.char_array[9 + 9 + IEndpoint::interval_offset] == 5);
+static_assert(poll_3ms<Speed::Full>.char_array[9 + 9 + IEndpoint::interval_offset] == 3);
+static_assert(poll_3ms_dual.Make(Speed::Full, false)[9 + 9 + IEndpoint::interval_offset] == 2);
+static_assert(poll_3ms_dual.num_patch == 1);
+
+// vendor defined 64 bytes in and out reports
+constexpr uint8_t MyReportDescr[] = {
+    0x06, 0x00, 0xff,   // usage page (vendor defined)
+    0x09, 0x01,         // usage
+    0xa1, 0x01,         // collection (application)
+    0x09, 0x02,         //   usage
+    0x15, 0x00,         //   logical minimum 0
+    0x26, 0xff, 0x00,   //   logical maximum 255
+    0x75, 0x08,         //   report size 8
+    0x95, 0x40,         //   report count 64
+    0x81, 0x02,         //   input
+    0x09, 0x03,         //   usage
+    0x15, 0x00,         //   logical minimum 0
+    0x26, 0xff, 0x00,   //   logical maximum 255
+    0x75, 0x08,         //   report size 8
+    0x95, 0x40,         //   report count 64
+    0x91, 0x02,         //   output
+    0xc0                // end collection
+};
+
+static constexpr auto hid_registry = MakeDescriptorRegistry(std::array{
+    MakeEntry(hid_device),
+    MakeEntry(hid),
+    MakeHidEntry(hid.char_array, 0),
+    MakeHidReportEntry(hid.char_array, 0, MyReportDescr)
+});
+static_assert(hid_registry.Find(0x22, 0, 0).data == MyReportDescr);
+static_assert(hid_registry.Find(0x22, 0, 0).len == 0x22);
+static_assert(hid_registry.Find(0x21, 0, 0).data == hid.char_array.desc + 18);
+static_assert(hid_registry.Find(0x22, 0, 1).data == nullptr);
+
+// EP0 data stage of every descriptor, the device has max_pack_size0 8
+static_assert(CheckEp0Registry(hid_registry));
+static_assert(CheckEp0(MakeSource<hid>(), MyCfgDescr_HS, 0xff, 8));
+
+// the serial number from the chip UID and bMaxPower from the power contract, set at boot
+static constexpr auto serial = USB_STR(u8"000000000000");
+static constexpr std::array serial_slots{StringSlot(0, 12)};
+static constexpr std::array power_slots{max_power_slot};
+
+static constexpr auto patched_serial = [] {
+    PatchedDescriptor<serial, serial_slots> patched;
+    patched.SetString(0, "CAFE1234");
+    return patched;
+}();
+static constexpr auto patched_hid = [] {
+    PatchedDescriptor<hid, power_slots> patched;
+    uint8_t power = 0xfa;
+    patched.Set(0, &power);
+    return patched;
+}();
+static_assert(sizeof(patched_serial) == 24 && sizeof(patched_hid) == 1);
+
+constexpr uint8_t MySerNumInfo[] = {
+    26, 3, 'C', 0, 'A', 0, 'F', 0, 'E', 0, '1', 0, '2', 0, '3', 0, '4', 0, ' ', 0, ' ', 0, ' ', 0, ' ', 0
+};
+static constexpr auto powered_hid = [] {
+    CharArray<hid.len> out = hid.char_array;
+    out[IConfig::power_offset] = 0xfa;
+    return out;
+}();
+static_assert(patched_serial[2] == 'C' && patched_serial[18] == ' ');
+
+// non ascii and too long serials are refused, the placeholder stays
+static constexpr auto refused_serial = [] {
+    PatchedDescriptor<serial, serial_slots> patched;
+    bool ok = !patched.SetString(0, "CAF\xc3\x89")
+        && !patched.SetString(0, "0123456789ABC")
+        && patched.SetString(0, "0123456789AB");
+    ok = ok && patched[24] == 'B' && !patched.SetString(0, "\xff") && patched[2] == '0';
+    return ok;
+}();
+static_assert(refused_serial);
+static_assert(CheckEp0(MakeSource<patched_serial>(), MySerNumInfo));
+static_assert(CheckEp0(MakeSource<patched_hid>(), powered_hid.desc));
+static_assert(CheckEp0(MakeSource<patched_hid>(), powered_hid.desc, 0xff, 8));
+
+// the finalized descriptor stays in its section, only bMaxPower is in RAM
+static constexpr auto patched_final_hid = [] {
+    PatchedDescriptor<hid_config_descriptor, power_slots> patched;
+    uint8_t power = 0xfa;
+    patched.Set(0, &power);
+    return patched;
+}();
+static_assert(sizeof(patched_final_hid) == 1);
+static_assert(CheckEp0(MakeSource<patched_final_hid>(), powered_hid.desc));
+
+// as firmware keeps it, set at boot and read by EP0 while the device runs
+static PatchedDescriptor<hid_config_descriptor, power_slots> boot_hid;
+static PatchedDescriptor<serial, serial_slots> boot_serial;
+static constexpr Ep0Source boot_hid_source = MakeSource<boot_hid>();
+static constexpr Ep0Source boot_serial_source = MakeSource<boot_serial>();
+static_assert(boot_hid_source.data == nullptr && boot_hid_source.len == hid.len);
+static_assert(boot_serial_source.data == nullptr && boot_serial_source.len == serial.len);
+
+void OnBoot(uint8_t power, const char* uid_hex) {
+    boot_hid.Set(0, &power);
+    boot_serial.SetString(0, uid_hex);
+}
@@ -0,0 +1,53 @@
+#include <cstddef>
+#include <cstdint>
+#include "tpusb/device.hpp"
+#include "ch32-uac.hpp"
+#include "ep0_host.hpp"
+
+// device, qualifier and config in one blob
+static constexpr auto device = Device{
+    DeviceInitPack{
+        .vendor_id = 0x1a86,
+        .product_id = 0xfe0c,
+        .bcd_device = 0x0100,
+        .manufacturer_str_id = 1,
+        .product_str_id = 2,
+        .serial_str_id = 3
+    },
+    test
+};
+
+constexpr uint8_t MyDevDescr[] = {
+    0x12, 0x01,
+    USB_WORD(0x0200),
+    0xef, 0x02, 0x01,   // iad, class defined by the functions
+    64,
+    USB_WORD(0x1a86),
+    USB_WORD(0xfe0c),
+    USB_WORD(0x0100),
+    1, 2, 3,
+    1
+};
+
+constexpr uint8_t MyQuaDescr[] = {
+    0x0a, 0x06,
+    USB_WORD(0x0200),
+    0xef, 0x02, 0x01,
+    64,
+    1,
+    0
+};
+
+static_assert(Compare(MyDevDescr, device.char_array.desc).diff == 0);
+static_assert(Compare(MyQuaDescr, DeviceQualifier{device}.char_array.desc).diff == 0);
+static_assert(sizeof(device) == 18);
+
+static constexpr auto blob = DescriptorBlob{device, DeviceQualifier{device}, test};
+static_assert(blob.len == 18 + 10 + 218);
+static_assert(blob.offsets[1] == 18 && blob.offsets[2] == 28);
+static_assert(blob.Get(2)[1] == 2 && blob.Size(2) == 218);
+static_assert(blob.Get(1)[0] == 10 && blob.Get(1)[1] == 6);
+
+// EP0 sends the descriptors of the blob
+static_assert(CheckEp0(MakeSource(blob.Get(0), blob.Size(0)), MyDevDescr));
+static_assert(CheckEp0(MakeSource(blob.Get(1), blob.Size(1)), MyQuaDescr));
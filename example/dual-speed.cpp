@@ -0,0 +1,33 @@
+#include <cstddef>
+#include <cstdint>
+#include "tpusb/device.hpp"
+#include "tpusb/bandwidth.hpp"
+#include "ch32-uac.hpp"
+#include "ep0_host.hpp"
+
+// full speed and other speed forms of the same config
+static constexpr std::array test_fs_endpoints{
+    FullSpeedEndpoint{0x01, 392, 1},    // 48kHz 2ch 32bit plus one sample
+    FullSpeedEndpoint{0x81, 3, 1}       // 10.14 feedback
+};
+static constexpr auto dual = MakeDualSpeedConfig<test, test_fs_endpoints>();
+static constexpr auto fs_test = dual.Make(Speed::Full, false);
+static constexpr auto other_speed_test = dual.Make(Speed::High, true);
+
+static_assert(dual.num_patch == 8);
+static_assert(sizeof(dual.patches) == 8 * sizeof(SpeedPatch));
+static_assert(Compare(MyCfgDescr_HS, dual.Make(Speed::High, false).desc).diff == 0);
+static_assert(fs_test[EndpointOffset(fs_test.desc, fs_test.desc_len, 0x01) + IEndpoint::max_pack_low_offset] == (392 & 0xff));
+static_assert(fs_test[EndpointOffset(fs_test.desc, fs_test.desc_len, 0x01) + IEndpoint::max_pack_high_offset] == (392 >> 8));
+static_assert(fs_test[EndpointOffset(fs_test.desc, fs_test.desc_len, 0x81) + IEndpoint::max_pack_low_offset] == 3);
+static_assert(fs_test[EndpointOffset(fs_test.desc, fs_test.desc_len, 0x83) + IEndpoint::interval_offset] == 1);
+static_assert(fs_test[EndpointOffset(fs_test.desc, fs_test.desc_len, 0x02) + IEndpoint::max_pack_low_offset] == 64);
+static_assert(fs_test[IConfig::type_offset] == 2);
+static_assert(other_speed_test[IConfig::type_offset] == 7);
+
+// the full speed form fits in a frame
+static_assert(MakePeriodicBandwidth(fs_test, Speed::Full).Fits());
+
+// EP0 patches the speed forms in while reading the config
+static_assert(CheckEp0(MakeSource<dual, Speed::Full, false>(), fs_test.desc));
+static_assert(CheckEp0(MakeSource<dual, Speed::High, true>(), other_speed_test.desc));
@@ -0,0 +1,52 @@
+#include <cstddef>
+#include <cstdint>
+#include "tpusb/layout.hpp"
+#include "ch32-uac.hpp"
+
+// endpoint table
+static constexpr auto& endpoints = endpoint_table<test>;
+static_assert(endpoints.num_endpoint == 5 && endpoints.num_alternate == 5 && endpoints.num_interface == 4);
+static_assert(endpoints.Find(1, 0).count == 0);
+static_assert(endpoints.Find(1, 1).first == 0 && endpoints.Find(1, 1).count == 2);
+static_assert(endpoints.begin(1, 1)->address == 0x01);
+static_assert(endpoints.begin(1, 1)->type == TransferType::Isochronous);
+static_assert(endpoints.begin(1, 1)->sync_type == SynchronousType::Isochronous);
+static_assert(endpoints.begin(1, 1)[1].endpoint_type == IsoEpType::Feedback);
+static_assert(endpoints.begin(1, 1)->max_pack_size == 1024);
+static_assert(endpoints.Find(2, 0).first == 2 && endpoints.begin(2, 0)->interval == 4);
+static_assert(endpoints.end(3, 0) - endpoints.begin(3, 0) == 2);
+
+// an alternate setting or interface the config does not have is an empty range
+static_assert(endpoints.Contains(1, 1) && !endpoints.Contains(1, 2) && !endpoints.Contains(9, 0));
+static_assert(endpoints.Find(1, 2).count == 0 && endpoints.begin(1, 2) == endpoints.end(1, 2));
+static_assert(endpoints.Find(0xff, 0).count == 0 && endpoints.begin(0xff, 0) == endpoints.end(0xff, 0));
+
+static constexpr auto gap_config =
+Config{
+    ConfigInitPack{
+        1, 0, 0x80, 50
+    },
+    Interface{
+        InterfaceInitPack{
+            0, 0, 0xff, 0, 0, 0
+        },
+        Endpoint{
+            BulkInitPack{
+                0x01, 512, 0
+            }
+        }
+    },
+    Interface{
+        InterfaceInitPack{
+            2, 0, 0xff, 0, 0, 0
+        },
+        Endpoint{
+            BulkInitPack{
+                0x82, 512, 0
+            }
+        }
+    }
+};
+static constexpr auto& gap_endpoints = endpoint_table<gap_config>;
+static_assert(!gap_endpoints.Contains(1, 0) && gap_endpoints.begin(1, 0) == gap_endpoints.end(1, 0));
+static_assert(gap_endpoints.Contains(2, 0) && gap_endpoints.begin(2, 0)->address == 0x82);
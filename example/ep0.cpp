@@ -0,0 +1,12 @@
+#include <cstddef>
+#include <cstdint>
+#include "tpusb/ep0.hpp"
+#include "ch32-uac.hpp"
+#include "ep0_host.hpp"
+
+// EP0 data stage, a stall, a zero EP0 size and a missing read buffer, then the config straight from flash
+static_assert(CheckEp0Stall());
+static_assert(CheckEp0ZeroPacketSize());
+static_assert(CheckEp0NoBuffer());
+static_assert(CheckEp0(MakeSource<test>(), MyCfgDescr_HS));
+static_assert(MakeSource<test>().data == test.char_array.desc);
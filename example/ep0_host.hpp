@@ -0,0 +1,128 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "tpusb/ep0.hpp"
+
+// stands in for the usb controller, keeps every packet EP0 sent
+struct Ep0TestDouble {
+    uint8_t data[4096]{};
+    size_t len = 0;
+    uint16_t packet_len[520]{};
+    size_t num_packet = 0;
+    bool stalled = false;
+
+    constexpr void Send(const uint8_t* packet, uint16_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            data[len + i] = packet[i];
+        }
+        len += n;
+        packet_len[num_packet++] = n;
+    }
+
+    constexpr void Stall() {
+        stalled = true;
+    }
+};
+
+// read $source like a host asking for $w_length bytes, the packets must carry the first bytes of $expect
+constexpr bool CheckEp0(const Ep0Source& source, const uint8_t* expect, uint16_t w_length, uint16_t max_pack_size0) {
+    Ep0TestDouble hw;
+    // room for the super speed EP0
+    Ep0Sender<Ep0TestDouble, 512> sender{hw};
+    sender.Start(source, w_length, max_pack_size0);
+    // the host stops at a short packet or once it has $w_length bytes
+    while (hw.num_packet > 0 && hw.packet_len[hw.num_packet - 1] == max_pack_size0 && hw.len < w_length) {
+        size_t num_packet = hw.num_packet;
+        sender.OnInComplete();
+        if (hw.num_packet == num_packet) {
+            return false;
+        }
+    }
+    size_t num_packet = hw.num_packet;
+    sender.OnInComplete();
+    if (hw.stalled || hw.num_packet != num_packet) {
+        return false;
+    }
+
+    size_t total = source.len < w_length ? source.len : w_length;
+    bool zlp = total < w_length && total % max_pack_size0 == 0;
+    if (hw.len != total || hw.num_packet != total / max_pack_size0 + (total % max_pack_size0 != 0 || zlp ? 1 : 0)) {
+        return false;
+    }
+    for (size_t i = 0; i + 1 < hw.num_packet; ++i) {
+        if (hw.packet_len[i] != max_pack_size0) {
+            return false;
+        }
+    }
+    if (zlp && hw.packet_len[hw.num_packet - 1] != 0) {
+        return false;
+    }
+    for (size_t i = 0; i < total; ++i) {
+        if (hw.data[i] != expect[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// every max_pack_size0 and the wLength hosts use, around the length and the packet boundaries
+constexpr bool CheckEp0(const Ep0Source& source, const uint8_t* expect) {
+    constexpr uint16_t max_pack_size0s[] = {8, 16, 32, 64, 512};
+    for (uint16_t mps0 : max_pack_size0s) {
+        uint16_t len = source.len;
+        uint16_t w_lengths[] = {
+            1, 8, 9, 18, 64, 255, 0xffff,
+            len, static_cast<uint16_t>(len - 1), static_cast<uint16_t>(len + 1),
+            static_cast<uint16_t>(len / mps0 * mps0), static_cast<uint16_t>(len / mps0 * mps0 + mps0)
+        };
+        for (uint16_t w_length : w_lengths) {
+            if (w_length != 0 && !CheckEp0(source, expect, w_length, mps0)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// an unknown descriptor STALLs
+constexpr bool CheckEp0Stall() {
+    Ep0TestDouble hw;
+    Ep0Sender<Ep0TestDouble> sender{hw};
+    sender.Start(Ep0Source{}, 64);
+    return hw.stalled && hw.num_packet == 0;
+}
+
+// a zero max_pack_size0 STALLs instead of dividing by it
+constexpr bool CheckEp0ZeroPacketSize() {
+    constexpr uint8_t byte[] = {0};
+    Ep0InTransfer transfer;
+    Ep0Packet packet;
+    if (transfer.Start(MakeSource(byte, 1), 64, 0) || transfer.Next(packet)) {
+        return false;
+    }
+    Ep0TestDouble hw;
+    Ep0Sender<Ep0TestDouble> sender{hw};
+    sender.Start(MakeSource(byte, 1), 64, 0);
+    return hw.stalled && hw.num_packet == 0;
+}
+
+// a source read into a packet buffer has nothing to read into without one
+constexpr bool CheckEp0NoBuffer() {
+    Ep0Source source{};
+    source.len = 1;
+    source.read = [](size_t, uint8_t*, size_t n) { return n; };
+    Ep0InTransfer transfer;
+    Ep0Packet packet;
+    return !transfer.Start(source, 64, 64) && !transfer.Next(packet);
+}
+
+// every descriptor of a @DescriptorRegistry
+template<class REGISTRY>
+constexpr bool CheckEp0Registry(const REGISTRY& registry) {
+    for (size_t i = 0; i < REGISTRY::num_entry; ++i) {
+        if (!CheckEp0(MakeSource(registry.refs[i].data, registry.refs[i].len), registry.refs[i].data)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+#include <cstddef>
+#include <cstdint>
+#include "tpusb/usb.hpp"
+#include "tpusb/device.hpp"
+#include "tpusb/layout.hpp"
+#include "tpusb/bandwidth.hpp"
+#include "tpusb/buffer.hpp"
+#include "ep0_host.hpp"
+
+// high bandwidth, 24ch 192kHz 32bit is 2304 bytes per microframe, plus one sample
+static constexpr auto hb_test =
+Config{
+    ConfigInitPack{
+        1, 0, 0x80, 250
+    },
+    Interface{
+        InterfaceInitPack{
+            0, 0, 0x01, 0x02, 0x20, 0
+        },
+        Endpoint{
+            HighBandwidthIsochronousInitPack{
+                0x01, 2400, 1, SynchronousType::Isochronous, IsoEpType::Data
+            }
+        },
+        Endpoint{
+            HighBandwidthInterruptInitPack{
+                0x82, 1500, 1
+            }
+        }
+    }
+};
+static_assert(EncodeHighBandwidth(1024) == 1024);
+static_assert(EncodeHighBandwidth(1025) == (513 | (1 << 11)));
+static_assert(EncodeHighBandwidth(3072) == (1024 | (2 << 11)));
+static_assert(hb_test.char_array[9 + 9 + IEndpoint::max_pack_low_offset] == (800 & 0xff));
+static_assert(hb_test.char_array[9 + 9 + IEndpoint::max_pack_high_offset] == ((800 | (2 << 11)) >> 8));
+static_assert(hb_test.char_array[9 + 9 + 7 + IEndpoint::max_pack_high_offset] == ((750 | (1 << 11)) >> 8));
+// super speed sends it as a burst of 3 packets
+static constexpr auto hb_ss_test = MakeSuperSpeedConfig<hb_test>();
+static_assert(hb_ss_test.char_array[9 + 9 + 7 + 2] == 2);
+static_assert(hb_ss_test.char_array[9 + 9 + 7 + 4] == (2400 & 0xff));
+
+// 3 transactions a microframe in the bus time, the packet memory, the endpoint table and EP0
+static_assert(periodic_bandwidth<hb_test, Speed::High>.Fits());
+static_assert(periodic_bandwidth<hb_test, Speed::High>.Percent() == 64);
+static_assert(buffer_plan<hb_test>.Find(0x01).size == 2400);
+static_assert(endpoint_table<hb_test>.endpoints[0].transactions == 3);
+static_assert(CheckEp0(MakeSource<hb_test>(), hb_test.char_array.desc));
@@ -0,0 +1,21 @@
+#include <cstddef>
+#include <cstdint>
+#include "tpusb/layout.hpp"
+#include "tpusb/device.hpp"
+#include "ch32-uac.hpp"
+
+// layout map and statistics
+static constexpr auto& layout = descriptor_layout<test>;
+static_assert(layout.size == 25);
+static_assert(layout[1].type == 0xb && layout[1].offset == 9);
+static_assert(layout[4].type == 0x24 && layout[4].subtype == 0x0a && layout[4].length == 8);
+static_assert(layout.stats.num_interface == 4);
+static_assert(layout.stats.num_endpoint == 5);
+static_assert(layout.stats.class_bytes[0x01] == 143);
+static_assert(layout.stats.class_bytes[0x02] == 43);
+static_assert(layout.stats.class_bytes[0x0a] == 23);
+static_assert(layout.stats.transfer_type_bytes[static_cast<size_t>(TransferType::Isochronous)] == 22);
+static_assert(layout.stats.transfer_type_bytes[static_cast<size_t>(TransferType::Bulk)] == 14);
+static_assert(layout.stats.transfer_type_count[static_cast<size_t>(TransferType::Interrupt)] == 1);
+static_assert(layout.stats.Ep0Packets(64) == 4);
+static_assert(layout.stats.Ep0Packets(MaxPacketSize0(Speed::Super)) == 1);
@@ -1,5 +1,6 @@
 #include "tpusb/midiv1.hpp"
 #include "example/comp.hpp"
+#include "example/ep0_host.hpp"
 #include "tpusb/usb.hpp"
 #include <cstdint>
 
@@ -11,7 +12,8 @@ Config{
         .config_no = 1,
         .str_id = 0,
         .attribute = 0x80,
-        .power = 250
+        .power = 250,
+        .speed = Speed::Full
     },
     midiv1::MIDIStreamInterface{
         InterfaceInitPackClassed{
@@ -570,3 +572,12 @@ static constexpr uint32_t fs[] {
     cmp.diff
 };
 static_assert(cmp.diff == 0);
+
+static_assert(CheckEp0(MakeSource<config>(), USBD_MIDI_CfgDesc));
+
+// full speed bulk is 8, 16, 32 or 64 bytes, high speed bulk is 512
+static_assert(LegalMaxPacketSize(TransferType::Bulk, Speed::Full, 64));
+static_assert(!LegalMaxPacketSize(TransferType::Bulk, Speed::Full, 48));
+static_assert(!LegalMaxPacketSize(TransferType::Bulk, Speed::High, 64));
+static_assert(!LegalMaxPacketSize(TransferType::Control, Speed::Full, 12));
+static_assert(LegalMaxPacketSize(TransferType::Interrupt, Speed::Full, 12));
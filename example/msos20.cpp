@@ -0,0 +1,185 @@
+#include <cstddef>
+#include <cstdint>
+#include "tpusb/usb.hpp"
+#include "tpusb/cdc.hpp"
+#include "tpusb/device.hpp"
+#include "tpusb/msos20.hpp"
+#include "tpusb/registry.hpp"
+#include "comp.hpp"
+#include "ep0_host.hpp"
+
+// cdc and a driverless WinUSB vendor interface
+static constexpr auto vendor_config =
+Config{
+    ConfigInitPack{
+        1, 0, 0x80, 50, Speed::Full
+    },
+    InterfaceAssociation{
+        InterfaceAssociationInitPack{
+            0, 2, 1, 0
+        },
+        CDCControlInterface{
+            InterfaceInitPackClassed{
+                0, 0, 1, 0
+            },
+            FunctionDesc{
+                0x0110
+            },
+            CDCLength{
+                0, 1
+            },
+            CDCManagement{
+                2
+            },
+            CDCInterfaceSpecify{
+                0, 1
+            },
+            Endpoint{
+                InterruptInitPack{
+                    0x81, 8, 16
+                }
+            }
+        },
+        CDCDataInterface{
+            InterfaceInitPackClassed{
+                1, 0, 0, 0
+            },
+            Endpoint{
+                BulkInitPack{
+                    0x02, 64, 0
+                }
+            },
+            Endpoint{
+                BulkInitPack{
+                    0x82, 64, 0
+                }
+            }
+        }
+    },
+    Interface{
+        InterfaceInitPack{
+            2, 0, 0xff, 0, 0, 0
+        },
+        Endpoint{
+            BulkInitPack{
+                0x03, 64, 0
+            }
+        },
+        Endpoint{
+            BulkInitPack{
+                0x83, 64, 0
+            }
+        }
+    }
+};
+
+static constexpr auto ms_os_20 =
+MSOS20DescriptorSet{
+    MSOS20SetInitPack{
+        .vendor_code = 0x01
+    },
+    MSOS20ConfigurationSubset{
+        vendor_config,
+        MSOS20FunctionSubset{
+            2,
+            MSOS20CompatibleId{"WINUSB"},
+            MSOS20DeviceInterfaceGUIDs(USB_STR(u8"{975F44D9-0D08-43FD-8B3E-127CA8AFFF9D}"))
+        }
+    }
+};
+
+static constexpr auto bos =
+BOS{
+    USB20Extension{
+        0
+    },
+    MSOS20Platform{
+        ms_os_20
+    }
+};
+
+#define USB_WORD(X) X & 0xff, X >> 8
+#define USB_DWORD(X) X & 0xff, (X >> 8) & 0xff, (X >> 16) & 0xff, (X >> 24)
+
+constexpr uint8_t MyMSOS20Descr[] = {
+    // set header
+    USB_WORD(0x000a), USB_WORD(0x0000), USB_DWORD(0x06030000), USB_WORD(0x00b2),
+    // configuration subset header, configuration index 0
+    USB_WORD(0x0008), USB_WORD(0x0001), 0, 0, USB_WORD(0x00a8),
+    // function subset header, first interface 2
+    USB_WORD(0x0008), USB_WORD(0x0002), 2, 0, USB_WORD(0x00a0),
+    // compatible id
+    USB_WORD(0x0014), USB_WORD(0x0003), 'W', 'I', 'N', 'U', 'S', 'B', 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    // registry property
+    USB_WORD(0x0084), USB_WORD(0x0004),
+    USB_WORD(0x0007), USB_WORD(0x002a),
+    'D', 0, 'e', 0, 'v', 0, 'i', 0, 'c', 0, 'e', 0, 'I', 0, 'n', 0, 't', 0, 'e', 0,
+    'r', 0, 'f', 0, 'a', 0, 'c', 0, 'e', 0, 'G', 0, 'U', 0, 'I', 0, 'D', 0, 's', 0,
+    0, 0,
+    USB_WORD(0x0050),
+    '{', 0, '9', 0, '7', 0, '5', 0, 'F', 0, '4', 0, '4', 0, 'D', 0, '9', 0, '-', 0,
+    '0', 0, 'D', 0, '0', 0, '8', 0, '-', 0, '4', 0, '3', 0, 'F', 0, 'D', 0, '-', 0,
+    '8', 0, 'B', 0, '3', 0, 'E', 0, '-', 0, '1', 0, '2', 0, '7', 0, 'C', 0, 'A', 0,
+    '8', 0, 'A', 0, 'F', 0, 'F', 0, 'F', 0, '9', 0, 'D', 0, '}', 0, 0, 0, 0, 0
+};
+
+constexpr uint8_t MyBOSDescr[] = {
+    0x05, 0x0f, USB_WORD(40), 2,
+    // usb 2.0 extension
+    0x07, 0x10, 0x02, USB_DWORD(0),
+    // ms os 2.0 platform capability
+    0x1c, 0x10, 0x05, 0x00,
+    0xdf, 0x60, 0xdd, 0xd8, 0x89, 0x45, 0xc7, 0x4c,
+    0x9c, 0xd2, 0x65, 0x9d, 0x9e, 0x64, 0x8a, 0x9f,
+    USB_DWORD(0x06030000), USB_WORD(0x00b2), 0x01, 0x00
+};
+
+static_assert(ms_os_20.len == 0xb2);
+static_assert(Compare(MyMSOS20Descr, ms_os_20.char_array.desc).diff == 0);
+static_assert(bos.len == 40);
+static_assert(Compare(MyBOSDescr, bos.char_array.desc).diff == 0);
+
+// bos needs bcd_usb 0x0210
+static constexpr auto vendor_device = Device{
+    DeviceInitPack{
+        .vendor_id = 0xcafe,
+        .product_id = 0x4011,
+        .bcd_device = 0x0100,
+        .manufacturer_str_id = 1,
+        .product_str_id = 2,
+        .serial_str_id = 3,
+        .bcd_usb = 0x0210,
+        .speed = Speed::Full
+    },
+    vendor_config
+};
+static_assert(vendor_device.char_array[IDevice::class_offset] == 0xef);
+
+// GET_DESCRIPTOR lookup
+static constexpr auto lang_id = CustomDesc{std::array{4, 3, 0x09, 0x04}};
+static constexpr auto manufacturer = USB_STR(u8"tpusb");
+static constexpr auto product = USB_STR(u8"tpusb WinUSB");
+static constexpr auto serial = USB_STR(u8"0001");
+
+static constexpr auto registry = MakeDescriptorRegistry(std::array{
+    MakeEntry(vendor_device),
+    MakeEntry(vendor_config),
+    MakeEntry(bos),
+    MakeEntry(lang_id),
+    MakeEntry(manufacturer, 1, 0x0409),
+    MakeEntry(product, 2, 0x0409),
+    MakeEntry(serial, 3, 0x0409)
+});
+static_assert(registry.Find(1, 0, 0).data == vendor_device.char_array.desc);
+static_assert(registry.Find(2, 0, 0).len == vendor_config.len);
+static_assert(registry.Find(0x0f, 0, 0).len == 40);
+static_assert(registry.Find(3, 0, 0).data == lang_id.char_array.desc);
+static_assert(registry.Find(3, 2, 0x0409).data == product.char_array.desc);
+static_assert(registry.Find(3, 4, 0x0409).data == nullptr);
+static_assert(registry.Find(3, 1, 0x0407).len == 0);
+static_assert(registry.Find(6, 0, 0).data == nullptr);
+
+// EP0 data stage of every descriptor, the MS OS 2.0 set is sent on a vendor request
+static_assert(CheckEp0Registry(registry));
+static_assert(CheckEp0(MakeSource<ms_os_20>(), MyMSOS20Descr));
@@ -0,0 +1,93 @@
+#include <cstddef>
+#include <cstdint>
+#include "tpusb/usb.hpp"
+#include "tpusb/usb_str.hpp"
+#include "tpusb/cdc.hpp"
+#include "comp.hpp"
+#include "ep0_host.hpp"
+
+// every str_id takes the string, "Serial" is stored once
+static constexpr auto make_config = [](auto& str) {
+    return Config{
+        ConfigInitPack{
+            1, str(u8"Default"), 0x80, 50, Speed::Full
+        },
+        InterfaceAssociation{
+            InterfaceAssociationInitPack{
+                0, 2, 1, str(u8"Serial")
+            },
+            CDCControlInterface{
+                InterfaceInitPackClassed{
+                    0, 0, 1, str(u8"Serial")
+                },
+                FunctionDesc{
+                    0x0110
+                },
+                CDCLength{
+                    0, 1
+                },
+                CDCManagement{
+                    2
+                },
+                CDCInterfaceSpecify{
+                    0, 1
+                },
+                Endpoint{
+                    InterruptInitPack{
+                        0x81, 8, 4
+                    }
+                }
+            },
+            CDCDataInterface{
+                InterfaceInitPackClassed{
+                    1, 0, 0, str(u8"")
+                },
+                Endpoint{
+                    BulkInitPack{
+                        0x02, 64, 0
+                    }
+                },
+                Endpoint{
+                    BulkInitPack{
+                        0x82, 64, 0
+                    }
+                }
+            }
+        },
+        Interface{
+            InterfaceInitPack{
+                2, 0, 0xff, 0, 0, str(u8"Vendor µ")
+            }
+        }
+    };
+};
+
+static constexpr auto strings = MakeStringTable(make_config);
+static constexpr auto config = make_config(strings);
+
+constexpr uint8_t MyStringPool[] = {
+    4, 3, 0x09, 0x04,
+    16, 3, 'D', 0, 'e', 0, 'f', 0, 'a', 0, 'u', 0, 'l', 0, 't', 0,
+    14, 3, 'S', 0, 'e', 0, 'r', 0, 'i', 0, 'a', 0, 'l', 0,
+    18, 3, 'V', 0, 'e', 0, 'n', 0, 'd', 0, 'o', 0, 'r', 0, ' ', 0, 0xb5, 0
+};
+
+static_assert(strings.num_string == 4);
+static_assert(Compare(MyStringPool, strings.pool.desc).diff == 0);
+static_assert(strings.offsets[2] == 20 && strings.Size(2) == 14);
+static_assert(strings(u8"Serial") == 2);
+static_assert(config.char_array[6] == 1);
+static_assert(config.char_array[9 + 7] == 2);
+static_assert(config.char_array[9 + 8 + 8] == 2);
+
+// EP0 data stage of every string of the pool
+constexpr bool CheckStrings() {
+    for (size_t i = 0; i < strings.num_string; ++i) {
+        if (!CheckEp0(MakeSource(strings.Get(i), strings.Size(i)), MyStringPool + strings.offsets[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(CheckStrings());
+static_assert(CheckEp0(MakeSource<config>(), config.char_array.desc));
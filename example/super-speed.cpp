@@ -0,0 +1,78 @@
+#include <cstddef>
+#include <cstdint>
+#include "tpusb/device.hpp"
+#include "ch32-uac.hpp"
+#include "ep0_host.hpp"
+
+// super speed form, a companion after every endpoint
+static constexpr auto ss_test = MakeSuperSpeedConfig<test>(std::array{
+    SuperSpeedEndpoint{0x02, 1024, 3, 0, 0},   // cdc out bursts 4 packets
+    SuperSpeedEndpoint{0x82, 1024, 0, 4, 0}    // cdc in has 16 streams
+});
+static constexpr auto& ss_layout = descriptor_layout<ss_test>;
+static_assert(ss_test.len == 218 + 5 * 6);
+static_assert(ss_test.char_array[IConfig::total_len_offset] == ((218 + 5 * 6) & 0xff));
+static_assert(ss_layout.size == 30);
+static_assert(ss_layout.stats.num_endpoint == 5);
+static_assert(ss_layout.stats.transfer_type_bytes[static_cast<size_t>(TransferType::Isochronous)] == 22 + 12);
+constexpr bool CheckCompanions() {
+    for (size_t i = 0; i < ss_layout.size; ++i) {
+        if (ss_layout[i].type == 5 && ss_layout[i + 1].type != 0x30) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(CheckCompanions());
+static_assert(ss_test.char_array[EndpointOffset(ss_test.char_array.desc, ss_test.len, 0x01) + 7 + 4] == (1024 & 0xff));
+static_assert(ss_test.char_array[EndpointOffset(ss_test.char_array.desc, ss_test.len, 0x01) + 7 + 5] == (1024 >> 8));
+static_assert(ss_test.char_array[EndpointOffset(ss_test.char_array.desc, ss_test.len, 0x82) + IEndpoint::max_pack_high_offset] == (1024 >> 8));
+static_assert(ss_test.char_array[EndpointOffset(ss_test.char_array.desc, ss_test.len, 0x02) + 7 + 2] == 3);
+static_assert(ss_test.char_array[EndpointOffset(ss_test.char_array.desc, ss_test.len, 0x82) + 7 + 3] == 4);
+static_assert(LegalCompanionAttribute(TransferType::Bulk, 16) && !LegalCompanionAttribute(TransferType::Bulk, 17));
+static_assert(LegalCompanionAttribute(TransferType::Isochronous, 2) && !LegalCompanionAttribute(TransferType::Isochronous, 3));
+static_assert(!LegalCompanionAttribute(TransferType::Interrupt, 1));
+
+// a companion nested by hand is checked against its endpoint by the config
+static constexpr auto nested_ss_test =
+Config{
+    ConfigInitPack{
+        1, 0, 0x80, 50, Speed::Super
+    },
+    Interface{
+        InterfaceInitPack{
+            0, 0, 0xff, 0, 0, 0
+        },
+        Endpoint{
+            BulkInitPack{
+                0x01, 1024, 0
+            },
+            SuperSpeedCompanion{
+                15, 16, 0
+            }
+        }
+    }
+};
+static_assert(CountEndpointWithoutCompanion(nested_ss_test.char_array.desc, nested_ss_test.char_array.desc_len) == 0);
+
+// EP0 sizes are bytes, only bMaxPacketSize0 of a super speed device is an exponent
+static_assert(MaxPacketSize0(Speed::High) == 64 && MaxPacketSize0(Speed::Super) == 512);
+static_assert(MaxPacketSize0Exponent(512) == 9);
+static constexpr auto ss_device = Device{
+    DeviceInitPack{
+        .vendor_id = 0x1a86,
+        .product_id = 0xfe0c,
+        .bcd_device = 0x0100,
+        .manufacturer_str_id = 1,
+        .product_str_id = 2,
+        .serial_str_id = 3,
+        .bcd_usb = 0x0320,
+        .speed = Speed::Super
+    },
+    ss_test
+};
+static_assert(ss_device.char_array[IDevice::max_pack_size0_offset] == 9);
+static_assert(DeviceQualifier{ss_device}.char_array[7] == 64);
+
+// EP0 reads the super speed config from flash
+static_assert(CheckEp0(MakeSource<ss_test>(), ss_test.char_array.desc));
@@ -1,3 +1,4 @@
+#include "ep0_host.hpp"
 #include "comp.hpp"
 #include "tpusb/usb_str.hpp"
 
@@ -27,3 +28,74 @@ static constexpr auto str3 = USB_STR(u8"0123456789");
 static constexpr auto cmp1 = Compare(MyManuInfo, str1.char_array.desc);
 static constexpr auto cmp2 = Compare(MyProdInfo, str2.char_array.desc);
 static constexpr auto cmp3 = Compare(MySerNumInfo, str3.char_array.desc);
+
+/* Non-BMP character, U+1F3B5 encoded as surrogate pair */
+constexpr uint8_t  MyNoteInfo[] =
+{
+    0x0E, 0x03, 'M', 0, 'I', 0, 'D', 0, 'I', 0, 0x3C, 0xD8, 0xB5, 0xDF
+};
+
+static constexpr auto str4 = USB_STR(u8"MIDI\U0001F3B5");
+static constexpr auto cmp4 = Compare(MyNoteInfo, str4.char_array.desc);
+
+static_assert(cmp1.diff == 0);
+static_assert(cmp2.diff == 0);
+static_assert(cmp3.diff == 0);
+static_assert(cmp4.diff == 0);
+
+// malformed utf8 is rejected, USB_STR throws on them
+constexpr char overlong_nul[] = {'\xc0', '\x80', 0};
+constexpr char overlong_slash[] = {'\xe0', '\x80', '\xaf', 0};
+constexpr char overlong_euro[] = {'\xf0', '\x82', '\x82', '\xac', 0};
+constexpr char surrogate[] = {'\xed', '\xa0', '\x80', 0};
+constexpr char above_max[] = {'\xf4', '\x90', '\x80', '\x80', 0};
+constexpr char truncated[] = {'\xe2', '\x82', 0};
+static_assert(internal::IsUtf8(u8"MIDI\U0001F3B5", sizeof(u8"MIDI\U0001F3B5")));
+static_assert(internal::IsUtf8(u8"\u0080\u0800\U00010000", sizeof(u8"\u0080\u0800\U00010000")));
+static_assert(!internal::IsUtf8(overlong_nul, sizeof(overlong_nul)));
+static_assert(!internal::IsUtf8(overlong_slash, sizeof(overlong_slash)));
+static_assert(!internal::IsUtf8(overlong_euro, sizeof(overlong_euro)));
+static_assert(!internal::IsUtf8(surrogate, sizeof(surrogate)));
+static_assert(!internal::IsUtf8(above_max, sizeof(above_max)));
+static_assert(!internal::IsUtf8(truncated, sizeof(truncated)));
+
+#if __cplusplus >= 202002L
+static constexpr auto cmp5 = Compare(MyManuInfo, usb_string<u8"wch.cn">.char_array.desc);
+static constexpr auto cmp6 = Compare(MyNoteInfo, usb_string<u8"MIDI\U0001F3B5">.char_array.desc);
+static_assert(cmp5.diff == 0);
+static_assert(cmp6.diff == 0);
+#endif
+
+// ascii strings keep 1 byte per character, widened when read
+static constexpr auto packed1 = USB_STR_PACKED(u8"wch.cn");
+static constexpr auto packed4 = USB_STR_PACKED(u8"MIDI\U0001F3B5");
+
+template<class PACKED, size_t N>
+constexpr bool SameAsPacked(const PACKED& packed, const uint8_t (&expect)[N], size_t chunk) {
+    uint8_t out[N]{};
+    size_t offset = 0;
+    while (offset < N) {
+        offset += packed.Read(offset, out + offset, chunk);
+    }
+    return PACKED::len == N && Compare(expect, out).diff == 0;
+}
+
+static_assert(packed1.ascii && sizeof(packed1) == 6);
+static_assert(!packed4.ascii && sizeof(packed4) == sizeof(MyNoteInfo));
+static_assert(SameAsPacked(packed1, MyManuInfo, 5));
+static_assert(SameAsPacked(packed1, MyManuInfo, 64));
+static_assert(SameAsPacked(packed4, MyNoteInfo, 3));
+static_assert(SameAsPacked(USB_STR_PACKED(u8"0123456789"), MySerNumInfo, 8));
+
+#if __cplusplus >= 202002L
+static_assert(usb_packed_string<u8"CH32V30x">.ascii);
+static_assert(SameAsPacked(usb_packed_string<u8"CH32V30x">, MyProdInfo, 7));
+static_assert(SameAsPacked(usb_packed_string<u8"MIDI\U0001F3B5">, MyNoteInfo, 7));
+#endif
+
+// EP0 data stage, the packed strings are widened packet by packet
+static_assert(CheckEp0(MakeSource<str1>(), MyManuInfo));
+static_assert(CheckEp0(MakeSource<str4>(), MyNoteInfo));
+static_assert(MakeSource<packed1>().read != nullptr);
+static_assert(CheckEp0(MakeSource<packed1>(), MyManuInfo));
+static_assert(CheckEp0(MakeSource<packed4>(), MyNoteInfo));
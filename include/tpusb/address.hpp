@@ -0,0 +1,201 @@
+#pragma once
+#include "usb.hpp"
+#include "layout.hpp"
+#include "controller.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// --------------------------------------------------------------------------------
+// ADDRESS
+// endpoints declared with @auto_in or @auto_out get their number from @AllocateEndpointAddress
+// the same endpoint of every alternate setting of an interface gets the same address,
+// the most constrained endpoints are numbered first, the controller is described by a @DefaultControllerTraits
+// --------------------------------------------------------------------------------
+
+// endpoint number 0 is the control endpoint, it never appears in a config, so it marks auto
+inline constexpr uint8_t auto_out = 0x00;
+inline constexpr uint8_t auto_in = 0x80;
+
+// an endpoint declared with @auto_in or @auto_out
+struct AutoEndpoint {
+    size_t offset = 0;
+    uint8_t interface_no = 0;
+    uint8_t alter = 0;
+    // the order among the auto endpoints of its direction in the alternate setting
+    uint8_t position = 0;
+    TransferType type = TransferType::Bulk;
+    bool in = false;
+    // 0 until numbered
+    uint8_t address = 0;
+};
+
+template<class TRAITS>
+struct EndpointAllocator {
+    // bit 0 OUT, bit 1 IN
+    uint8_t used[16]{};
+
+    // alternate settings may use an address more than once
+    constexpr void Reserve(uint8_t address) {
+        uint8_t number = address & 0xf;
+        bool in = (address & 0x80) != 0;
+        if (number >= TRAITS::num_endpoint) {
+            throw "endpoint number not supported by the controller";
+        }
+        used[number] |= in ? 2 : 1;
+        if (!TRAITS::share_number) {
+            used[number] = 3;
+        }
+    }
+
+    // how many numbers can do $type in the direction, fewer is more constrained
+    static constexpr size_t NumSupported(TransferType type, bool in) {
+        size_t count = 0;
+        for (uint8_t number = 1; number < TRAITS::num_endpoint && number < 16; ++number) {
+            if (TRAITS::Supports(number, type, in)) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    // isochronous, then bulk, then interrupt, then the one fewer numbers can do, else the declaration order
+    static constexpr bool NumberedBefore(const AutoEndpoint& a, const AutoEndpoint& b) {
+        constexpr uint8_t rank[4] = {3, 0, 1, 2};
+        uint8_t rank_a = rank[static_cast<size_t>(a.type)];
+        uint8_t rank_b = rank[static_cast<size_t>(b.type)];
+        if (rank_a != rank_b) {
+            return rank_a < rank_b;
+        }
+        return NumSupported(a.type, a.in) < NumSupported(b.type, b.in);
+    }
+
+    // $numbered are the endpoints given an address so far
+    constexpr uint8_t Allocate(const AutoEndpoint* numbered, size_t num_numbered, const AutoEndpoint& endpoint) {
+        // an address of the same interface from another alternate setting, the same position first,
+        // as long as this alternate setting does not use it and the number can do the type
+        uint8_t reuse = 0;
+        for (size_t i = 0; i < num_numbered; ++i) {
+            const AutoEndpoint& other = numbered[i];
+            if (other.interface_no != endpoint.interface_no || other.in != endpoint.in || other.alter == endpoint.alter
+                || !TRAITS::Supports(other.address & 0xf, endpoint.type, endpoint.in)) {
+                continue;
+            }
+            bool taken = false;
+            for (size_t j = 0; j < num_numbered; ++j) {
+                if (numbered[j].interface_no == endpoint.interface_no && numbered[j].alter == endpoint.alter
+                    && numbered[j].address == other.address) {
+                    taken = true;
+                }
+            }
+            if (taken) {
+                continue;
+            }
+            if (other.position == endpoint.position) {
+                return other.address;
+            }
+            if (reuse == 0) {
+                reuse = other.address;
+            }
+        }
+        if (reuse != 0) {
+            return reuse;
+        }
+
+        bool want_double = endpoint.type == TransferType::Isochronous || endpoint.type == TransferType::Bulk;
+        uint8_t best = 0;
+        int best_score = -1;
+        for (uint8_t number = 1; number < TRAITS::num_endpoint && number < 16; ++number) {
+            if ((used[number] & (endpoint.in ? 2 : 1)) != 0 || !TRAITS::Supports(number, endpoint.type, endpoint.in)) {
+                continue;
+            }
+            // pairing with the other direction saves a number, then the buffering, then the lowest number
+            int score = 0;
+            if (used[number] != 0) {
+                score += 2;
+            }
+            if (TRAITS::DoubleBuffered(number) == want_double) {
+                score += 1;
+            }
+            if (score > best_score) {
+                best = number;
+                best_score = score;
+            }
+        }
+        if (best_score < 0) {
+            throw "no endpoint number left for the endpoint";
+        }
+
+        uint8_t address = best | (endpoint.in ? 0x80 : 0);
+        Reserve(address);
+        return address;
+    }
+};
+
+/*
+ * a copy of $config with every @auto_in and @auto_out endpoint numbered, $config is made with auto_address
+ * the most constrained endpoints are numbered first, see @EndpointAllocator::NumberedBefore,
+ * so a bulk endpoint does not take the only number an isochronous one can use
+*/
+template<class TRAITS = DefaultControllerTraits, class CONFIG>
+constexpr CONFIG AllocateEndpointAddress(const CONFIG& config) {
+    static_assert(TRAITS::num_endpoint <= 16, "usb has 16 endpoint numbers");
+    using Allocator = EndpointAllocator<TRAITS>;
+    CONFIG out = config;
+    auto& desc = out.char_array;
+    Allocator allocator;
+
+    AutoEndpoint endpoints[CONFIG::len / 7 + 1]{};
+    size_t num_endpoint = 0;
+    uint8_t position[2]{};
+    WalkDescriptors(desc.desc, CONFIG::len, [&](const DescriptorInfo& info) {
+        if (info.type == 4) {
+            position[0] = position[1] = 0;
+        }
+        if (info.type != 5) {
+            return;
+        }
+        uint8_t address = desc[info.offset + IEndpoint::address_offset];
+        if ((address & 0xf) != 0) {
+            allocator.Reserve(address);
+            return;
+        }
+        bool in = (address & 0x80) != 0;
+        endpoints[num_endpoint++] = AutoEndpoint{
+            info.offset, info.interface_no, info.alter, position[in ? 1 : 0]++,
+            static_cast<TransferType>(info.transfer_type), in, 0
+        };
+    });
+
+    // stable, the declaration order breaks ties
+    for (size_t i = 1; i < num_endpoint; ++i) {
+        AutoEndpoint endpoint = endpoints[i];
+        size_t j = i;
+        while (j > 0 && Allocator::NumberedBefore(endpoint, endpoints[j - 1])) {
+            endpoints[j] = endpoints[j - 1];
+            --j;
+        }
+        endpoints[j] = endpoint;
+    }
+
+    for (size_t i = 0; i < num_endpoint; ++i) {
+        endpoints[i].address = allocator.Allocate(endpoints, i, endpoints[i]);
+        desc[endpoints[i].offset + IEndpoint::address_offset] = endpoints[i].address;
+    }
+    return out;
+}
+
+// bEndpointAddress of the $index th endpoint of an alternate setting
+template<size_t N>
+constexpr uint8_t EndpointAddressOf(const CharArray<N>& config, uint8_t interface_no, uint8_t alter, size_t index) {
+    uint8_t address = 0;
+    size_t i = 0;
+    WalkDescriptors(config.desc, N, [&](const DescriptorInfo& info) {
+        if (info.type == 5 && info.interface_no == interface_no && info.alter == alter && i++ == index) {
+            address = config[info.offset + IEndpoint::address_offset];
+        }
+    });
+    if (address == 0) {
+        throw "no such endpoint";
+    }
+    return address;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include "usb.hpp"
+#include "layout.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// --------------------------------------------------------------------------------
+// BANDWIDTH
+// bus time of the periodic endpoints, usb 2.0 spec 5.11.3, in picoseconds
+// every endpoint is counted in the same (micro)frame, whatever its interval is
+// --------------------------------------------------------------------------------
+
+// Floor(3.167 + BitStuffTime(Data_bc)), the bit times of a data packet
+constexpr uint64_t DataBitTimes(uint64_t bytes) {
+    return (3167 * 3 + 28000 * bytes) / 3000;
+}
+
+// bus time of one transaction, $host_delay_ps is the delay of the host controller
+constexpr uint64_t TransactionTime(Speed speed, TransferType type, bool in, uint64_t bytes, uint64_t host_delay_ps = 0) {
+    uint64_t bits = DataBitTimes(bytes);
+    if (speed == Speed::Full) {
+        if (type == TransferType::Isochronous) {
+            return (in ? 7268000 : 6265000) + 83540 * bits + host_delay_ps;
+        }
+        return 9107000 + 83540 * bits + host_delay_ps;
+    }
+    if (type == TransferType::Isochronous) {
+        return 38 * 8 * 2083 + 2083 * bits + host_delay_ps;
+    }
+    return 55 * 8 * 2083 + 2083 * bits + host_delay_ps;
+}
+
+struct PeriodicBandwidth {
+    // length of a frame or microframe
+    uint64_t frame_ps = 0;
+    // 90% of a full speed frame, 80% of a high speed microframe
+    uint64_t limit_ps = 0;
+    // the sum of the most expensive alternate setting of every interface
+    uint64_t worst_ps = 0;
+    uint64_t interface_ps[256]{};
+
+    constexpr bool Fits() const {
+        return worst_ps <= limit_ps;
+    }
+
+    // the worst case in percent of the (micro)frame
+    constexpr uint32_t Percent() const {
+        return static_cast<uint32_t>((worst_ps * 100 + frame_ps - 1) / frame_ps);
+    }
+};
+
+// $speed is Full or High, super speed has its own scheduling and is rejected
+template<size_t N>
+constexpr PeriodicBandwidth MakePeriodicBandwidth(const CharArray<N>& config, Speed speed, uint64_t host_delay_ps = 0) {
+    if (speed != Speed::Full && speed != Speed::High) {
+        throw "only the full and high speed periodic bandwidth is known";
+    }
+    PeriodicBandwidth bandwidth;
+    bandwidth.frame_ps = speed == Speed::Full ? 1000000000 : 125000000;
+    bandwidth.limit_ps = speed == Speed::Full ? bandwidth.frame_ps * 90 / 100 : bandwidth.frame_ps * 80 / 100;
+
+    uint8_t interface_no = no_interface;
+    uint8_t alter = 0;
+    uint64_t alter_ps = 0;
+    auto commit = [&bandwidth, &interface_no, &alter_ps] {
+        if (interface_no != no_interface && alter_ps > bandwidth.interface_ps[interface_no]) {
+            bandwidth.interface_ps[interface_no] = alter_ps;
+        }
+        alter_ps = 0;
+    };
+
+    WalkDescriptors(config.desc, N, [&](const DescriptorInfo& info) {
+        if (info.interface_no != interface_no || info.alter != alter) {
+            commit();
+            interface_no = info.interface_no;
+            alter = info.alter;
+        }
+        if (info.type != 5) {
+            return;
+        }
+        auto type = static_cast<TransferType>(info.transfer_type);
+        if (type != TransferType::Isochronous && type != TransferType::Interrupt) {
+            return;
+        }
+        bool in = (config[info.offset + IEndpoint::address_offset] & 0x80) != 0;
+        uint16_t max_pack_size = config[info.offset + IEndpoint::max_pack_low_offset]
+            | (config[info.offset + IEndpoint::max_pack_high_offset] << 8);
+        uint64_t transactions = ((max_pack_size >> 11) & 0x3) + 1;
+        alter_ps += transactions * TransactionTime(speed, type, in, max_pack_size & 0x7ff, host_delay_ps);
+    });
+    commit();
+
+    for (uint64_t ps : bandwidth.interface_ps) {
+        bandwidth.worst_ps += ps;
+    }
+    return bandwidth;
+}
+
+// eg. static_assert(periodic_bandwidth<config, Speed::High>.Fits());
+template<const auto& CONFIG, Speed SPEED>
+inline constexpr PeriodicBandwidth periodic_bandwidth = MakePeriodicBandwidth(CONFIG.char_array, SPEED);
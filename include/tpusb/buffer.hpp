@@ -0,0 +1,110 @@
+#pragma once
+#include "usb.hpp"
+#include "layout.hpp"
+#include "controller.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// --------------------------------------------------------------------------------
+// BUFFER
+// packet memory of the usb controller, one buffer per endpoint address, EP0 included
+// an address used by several alternate settings gets the largest max_pack_size of them,
+// isochronous and bulk are double buffered on the numbers the @DefaultControllerTraits says
+// --------------------------------------------------------------------------------
+
+struct EndpointBuffer {
+    uint8_t address;
+    TransferType type;
+    bool double_buffered;
+    // the second buffer of a double buffered endpoint is at offset + size
+    uint16_t offset;
+    uint16_t size;
+};
+
+template<size_t NUM_BUFFER>
+struct BufferPlan {
+    static constexpr size_t size = NUM_BUFFER;
+    EndpointBuffer buffers[NUM_BUFFER]{};
+    // end of the last buffer
+    size_t used = 0;
+    size_t capacity = 0;
+
+    constexpr bool Fits() const {
+        return used <= capacity;
+    }
+
+    constexpr const EndpointBuffer& operator[](size_t i) const {
+        return buffers[i];
+    }
+
+    constexpr const EndpointBuffer& Find(uint8_t address) const {
+        for (const auto& buffer : buffers) {
+            if (buffer.address == address) {
+                return buffer;
+            }
+        }
+        throw "no buffer for the address";
+    }
+};
+
+// the endpoint addresses of a config and the buffer each needs, $out can be nullptr, returns the number of them
+constexpr size_t CollectEndpointBuffers(const uint8_t* desc, size_t len, EndpointBuffer* out) {
+    // 16 numbers of 2 directions
+    EndpointBuffer found[32]{};
+    size_t count = 0;
+    WalkDescriptors(desc, len, [desc, &found, &count](const DescriptorInfo& info) {
+        if (info.type != 5) {
+            return;
+        }
+        uint8_t address = desc[info.offset + IEndpoint::address_offset];
+        uint16_t max_pack_size = desc[info.offset + IEndpoint::max_pack_low_offset]
+            | (desc[info.offset + IEndpoint::max_pack_high_offset] << 8);
+        // a high bandwidth endpoint keeps all the packets of a microframe
+        uint16_t size = (max_pack_size & 0x7ff) * (((max_pack_size >> 11) & 0x3) + 1);
+        for (size_t i = 0; i < count; ++i) {
+            if (found[i].address == address) {
+                if (size > found[i].size) {
+                    found[i].size = size;
+                }
+                return;
+            }
+        }
+        found[count++] = EndpointBuffer{address, static_cast<TransferType>(info.transfer_type), false, 0, size};
+    });
+    for (size_t i = 0; out != nullptr && i < count; ++i) {
+        out[i] = found[i];
+    }
+    return count;
+}
+
+template<const auto& CONFIG, class TRAITS = DefaultControllerTraits>
+constexpr auto MakeBufferPlan() {
+    constexpr const uint8_t* desc = CONFIG.char_array.desc;
+    constexpr size_t len = CONFIG.char_array.desc_len;
+    constexpr size_t num_ep0 = TRAITS::shared_ep0 ? 1 : 2;
+    constexpr size_t num_buffer = CollectEndpointBuffers(desc, len, nullptr) + num_ep0;
+
+    BufferPlan<num_buffer> plan;
+    plan.capacity = TRAITS::size;
+    plan.buffers[0] = EndpointBuffer{0x00, TransferType::Control, false, 0, TRAITS::max_pack_size0};
+    if constexpr (num_ep0 == 2) {
+        plan.buffers[1] = EndpointBuffer{0x80, TransferType::Control, false, 0, TRAITS::max_pack_size0};
+    }
+    CollectEndpointBuffers(desc, len, plan.buffers + num_ep0);
+
+    size_t offset = TRAITS::base;
+    for (auto& buffer : plan.buffers) {
+        buffer.double_buffered = (buffer.type == TransferType::Isochronous || buffer.type == TransferType::Bulk)
+            && TRAITS::DoubleBuffered(buffer.address & 0xf);
+        buffer.size = static_cast<uint16_t>((buffer.size + TRAITS::alignment - 1) / TRAITS::alignment * TRAITS::alignment);
+        offset = (offset + TRAITS::alignment - 1) / TRAITS::alignment * TRAITS::alignment;
+        buffer.offset = static_cast<uint16_t>(offset);
+        offset += buffer.double_buffered ? buffer.size * 2 : buffer.size;
+    }
+    plan.used = offset;
+    return plan;
+}
+
+// eg. static_assert(buffer_plan<config, MyMcuControllerTraits>.Fits());
+template<const auto& CONFIG, class TRAITS = DefaultControllerTraits>
+inline constexpr auto buffer_plan = MakeBufferPlan<CONFIG, TRAITS>();
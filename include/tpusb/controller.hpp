@@ -0,0 +1,45 @@
+#pragma once
+#include "usb.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// --------------------------------------------------------------------------------
+// CONTROLLER
+// what the usb controller of a MCU allows, one traits type for @AllocateEndpointAddress and @MakeBufferPlan
+// --------------------------------------------------------------------------------
+
+/*
+ * write your own for a MCU, deriving from this one keeps the members you do not care about
+ *
+ * endpoint numbers, see tpusb/address.hpp
+ * static constexpr uint8_t num_endpoint                  hardware endpoint numbers, 0 included
+ * static constexpr bool share_number                     IN and OUT can use one number
+ * static constexpr bool Supports(uint8_t number, TransferType type, bool in)
+ * static constexpr bool DoubleBuffered(uint8_t number)   the number has two buffers for isochronous and bulk,
+ *                                                        preferred by them when numbering
+ *
+ * packet memory, see tpusb/buffer.hpp
+ * static constexpr size_t size                           bytes of packet memory
+ * static constexpr size_t base                           first usable byte, eg. after the buffer table
+ * static constexpr size_t alignment                      of every buffer
+ * static constexpr uint16_t max_pack_size0
+ * static constexpr bool shared_ep0                       one buffer for both directions of EP0
+*/
+struct DefaultControllerTraits {
+    static constexpr uint8_t num_endpoint = 16;
+    static constexpr bool share_number = true;
+
+    static constexpr bool Supports(uint8_t, TransferType, bool) {
+        return true;
+    }
+
+    static constexpr bool DoubleBuffered(uint8_t) {
+        return true;
+    }
+
+    static constexpr size_t size = 4096;
+    static constexpr size_t base = 0;
+    static constexpr size_t alignment = 4;
+    static constexpr uint16_t max_pack_size0 = 64;
+    static constexpr bool shared_ep0 = false;
+};
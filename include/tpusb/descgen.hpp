@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// --------------------------------------------------------------------------------
+// HOST DESCRIPTOR CODEGEN
+// mark the descriptors of a TU with TPUSB_DESCRIPTOR(name, object)
+// tpusb_generate_descriptor() in cmake builds the TU into a host program
+// with TPUSB_DESCGEN defined, the program writes every marked descriptor
+// into a .c/.h pair, so the firmware only links the bytes
+// in any other build TPUSB_DESCRIPTOR only checks $DESC holds nothing but its bytes
+// --------------------------------------------------------------------------------
+
+#ifdef TPUSB_DESCGEN
+#include <vector>
+
+namespace tpusb {
+namespace descgen {
+
+struct Entry {
+    const char* name;
+    const uint8_t* data;
+    size_t len;
+};
+
+inline std::vector<Entry>& Registry() {
+    static std::vector<Entry> entries;
+    return entries;
+}
+
+struct Register {
+    Register(const char* name, const uint8_t* data, size_t len) {
+        Registry().push_back(Entry{name, data, len});
+    }
+};
+
+}
+}
+
+#define TPUSB_DESCRIPTOR(NAME, DESC)\
+    static const tpusb::descgen::Register tpusb_descgen_##NAME{#NAME, DESC.char_array.desc, DESC.char_array.desc_len}
+#else
+#define TPUSB_DESCRIPTOR(NAME, DESC)\
+    static_assert(sizeof(DESC.char_array.desc) == DESC.char_array.desc_len)
+#endif
@@ -1,7 +1,487 @@
 #pragma once
+#include "usb.hpp"
+#include "layout.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
 
 // --------------------------------------------------------------------------------
 // DEVICE
-// TODO
-//     add device structures
-// --------------------------------------------------------------------------------
\ No newline at end of file
+// --------------------------------------------------------------------------------
+
+// the largest EP0 packet allowed at the speed in bytes
+constexpr uint16_t MaxPacketSize0(Speed speed) {
+    switch (speed) {
+    case Speed::Full:
+    case Speed::High:
+        return 64;
+    case Speed::Super:
+        return 512;
+    }
+    return 0;
+}
+
+// bMaxPacketSize0 of a super speed device is the exponent of its EP0 size, 9 for 512 bytes
+constexpr uint8_t MaxPacketSize0Exponent(uint16_t max_pack_size0) {
+    uint8_t exponent = 0;
+    while ((1u << exponent) < max_pack_size0) {
+        ++exponent;
+    }
+    if ((1u << exponent) != max_pack_size0) {
+        throw "max_pack_size0 is not a power of 2";
+    }
+    return exponent;
+}
+
+struct DeviceInitPack {
+    uint16_t vendor_id;
+    uint16_t product_id;
+    uint16_t bcd_device;
+    uint8_t manufacturer_str_id;
+    uint8_t product_str_id;
+    uint8_t serial_str_id;
+    uint16_t bcd_usb = 0x0200;
+    // 0 means class defined by the interfaces, or EF/02/01 when any config has an interface association
+    uint8_t class_ = 0;
+    uint8_t subclass = 0;
+    uint8_t protocol = 0;
+    Speed speed = Speed::High;
+    // in bytes, 0 chooses @MaxPacketSize0 of the speed
+    uint16_t max_pack_size0 = 0;
+};
+
+struct IDevice {
+    static constexpr size_t bcd_usb_offset = 2;
+    static constexpr size_t class_offset = 4;
+    static constexpr size_t subclass_offset = 5;
+    static constexpr size_t protocol_offset = 6;
+    static constexpr size_t max_pack_size0_offset = 7;
+    static constexpr size_t vendor_id_offset = 8;
+    static constexpr size_t product_id_offset = 10;
+    static constexpr size_t bcd_device_offset = 12;
+    static constexpr size_t manufacturer_str_id_offset = 14;
+    static constexpr size_t product_str_id_offset = 15;
+    static constexpr size_t serial_str_id_offset = 16;
+    static constexpr size_t num_config_offset = 17;
+};
+
+template<size_t N>
+constexpr bool HasInterfaceAssociation(const CharArray<N>& desc) {
+    size_t offset = 0;
+    while (offset < N && desc[offset] != 0) {
+        if (desc[offset + 1] == 0xb) {
+            return true;
+        }
+        offset += desc[offset];
+    }
+    return false;
+}
+
+// 1. one @DeviceInitPack
+// 2. every @Config of the device, only used to fill the device descriptor
+struct Device : public IDevice {
+    static constexpr size_t len = 18;
+    CharArray<len> char_array {
+        len,
+        1
+    };
+
+    template<class... CONFIGS>
+    constexpr Device(DeviceInitPack pack, const CONFIGS&... configs) {
+        static_assert(sizeof...(CONFIGS) > 0, "a device needs at least one config");
+        char_array[2] = pack.bcd_usb & 0xff;
+        char_array[3] = pack.bcd_usb >> 8;
+        char_array[4] = pack.class_;
+        char_array[5] = pack.subclass;
+        char_array[6] = pack.protocol;
+        if (pack.class_ == 0 && (HasInterfaceAssociation(configs.char_array) || ...)) {
+            char_array[4] = 0xef;
+            char_array[5] = 0x02;
+            char_array[6] = 0x01;
+        }
+        uint16_t max_pack_size0 = pack.max_pack_size0 != 0 ? pack.max_pack_size0 : MaxPacketSize0(pack.speed);
+        char_array[7] = pack.speed == Speed::Super
+            ? MaxPacketSize0Exponent(max_pack_size0)
+            : static_cast<uint8_t>(max_pack_size0);
+        char_array[8] = pack.vendor_id & 0xff;
+        char_array[9] = pack.vendor_id >> 8;
+        char_array[10] = pack.product_id & 0xff;
+        char_array[11] = pack.product_id >> 8;
+        char_array[12] = pack.bcd_device & 0xff;
+        char_array[13] = pack.bcd_device >> 8;
+        char_array[14] = pack.manufacturer_str_id;
+        char_array[15] = pack.product_str_id;
+        char_array[16] = pack.serial_str_id;
+        char_array[17] = sizeof...(CONFIGS);
+
+        if (pack.speed == Speed::Super) {
+            if (max_pack_size0 != 512 || pack.bcd_usb < 0x0300) {
+                throw "super speed needs max_pack_size0 512 and bcd_usb 0x0300 or later";
+            }
+        }
+        else if (max_pack_size0 > MaxPacketSize0(pack.speed)
+            || (max_pack_size0 != 8 && max_pack_size0 != 16 && max_pack_size0 != 32 && max_pack_size0 != 64)
+            || (pack.speed == Speed::High && max_pack_size0 != 64)) {
+            throw "invalid max_pack_size0 for the speed";
+        }
+    }
+};
+
+// describes the device when it runs at the other speed, only for high speed capable devices
+struct DeviceQualifier {
+    static constexpr size_t len = 10;
+    CharArray<len> char_array {
+        len,
+        6
+    };
+
+    // $max_pack_size0 is bMaxPacketSize0 at the other speed, 0 keeps the one $device declares,
+    // a super speed device describes its high speed form here, so its EP0 is 64 bytes then
+    constexpr DeviceQualifier(const Device& device, uint8_t max_pack_size0 = 0) {
+        if (max_pack_size0 == 0) {
+            max_pack_size0 = device.char_array[IDevice::max_pack_size0_offset];
+            if (max_pack_size0 == 9) {
+                max_pack_size0 = 64;
+            }
+        }
+        if (max_pack_size0 != 8 && max_pack_size0 != 16 && max_pack_size0 != 32 && max_pack_size0 != 64) {
+            throw "invalid max_pack_size0 for the other speed";
+        }
+        char_array[2] = device.char_array[IDevice::bcd_usb_offset];
+        char_array[3] = device.char_array[IDevice::bcd_usb_offset + 1];
+        char_array[4] = device.char_array[IDevice::class_offset];
+        char_array[5] = device.char_array[IDevice::subclass_offset];
+        char_array[6] = device.char_array[IDevice::protocol_offset];
+        char_array[7] = max_pack_size0;
+        char_array[8] = device.char_array[IDevice::num_config_offset];
+        char_array[9] = 0;
+    }
+};
+
+// --------------------------------------------------------------------------------
+// BLOB
+// --------------------------------------------------------------------------------
+
+// the offset of every descriptor in a @DescriptorBlob
+template<class... DESCS>
+constexpr std::array<size_t, sizeof...(DESCS)> MakeBlobOffsets() {
+    constexpr size_t lens[] = {desc_len<DESCS>...};
+    std::array<size_t, sizeof...(DESCS)> offsets{};
+    size_t offset = 0;
+    for (size_t i = 0; i < sizeof...(DESCS); ++i) {
+        offsets[i] = offset;
+        offset += lens[i];
+    }
+    return offsets;
+}
+
+/*
+ * top level descriptors back to back in one array, so EP0 serves all of them from one flash region
+ * eg. DescriptorBlob{device, DeviceQualifier{device}, config}
+ * the $i th descriptor is Get(i) with Size(i) bytes, the blob can be finalized like any descriptor
+*/
+template<class... DESCS>
+struct DescriptorBlob {
+    static_assert(sizeof...(DESCS) > 0, "an empty blob");
+    static constexpr size_t len = DESC_LEN_SUMMER<DESCS...>::len;
+    static constexpr size_t count = sizeof...(DESCS);
+    static constexpr std::array<size_t, count> offsets = MakeBlobOffsets<DESCS...>();
+    static constexpr std::array<size_t, count> sizes = {desc_len<DESCS>...};
+    CharArray<len> char_array;
+
+    constexpr DescriptorBlob(const DESCS&... descs) {
+        size_t offset = 0;
+        ((offset = SerializeDesc(descs, char_array, offset)), ...);
+    }
+
+    constexpr const uint8_t* Get(size_t i) const {
+        return char_array.desc + offsets[i];
+    }
+
+    static constexpr size_t Size(size_t i) {
+        return sizes[i];
+    }
+};
+
+// --------------------------------------------------------------------------------
+// OTHER SPEED
+// one high speed @Config, its full speed form is a few patched endpoint bytes
+// --------------------------------------------------------------------------------
+
+// the full speed form of an endpoint which can not be derived from the high speed one
+struct FullSpeedEndpoint {
+    uint8_t address;
+    uint16_t max_pack_size;
+    uint8_t interval;
+};
+
+struct SpeedPatch {
+    uint16_t offset;
+    uint8_t value;
+};
+
+/*
+ * derive the full speed wMaxPacketSize and bInterval of a high speed endpoint
+ * periodic endpoints keep their bytes per millisecond, bulk endpoints are clamped to 64
+ * throw when the bandwidth does not fit in full speed, give a @FullSpeedEndpoint for it
+*/
+constexpr FullSpeedEndpoint DeriveFullSpeedEndpoint(uint8_t address, TransferType type, uint16_t max_pack_size, uint8_t interval) {
+    FullSpeedEndpoint fs{address, max_pack_size, interval};
+    if ((max_pack_size >> 11) != 0) {
+        throw "high bandwidth endpoint has no full speed form";
+    }
+    switch (type) {
+    case TransferType::Control:
+        break;
+    case TransferType::Bulk:
+        fs.max_pack_size = max_pack_size > 64 ? 64 : max_pack_size;
+        break;
+    case TransferType::Interrupt: {
+        if (interval == 0 || interval > 16) {
+            throw "invalid high speed interval";
+        }
+        uint32_t microframes = uint32_t{1} << (interval - 1);
+        if (microframes < 8) {
+            fs.max_pack_size = static_cast<uint16_t>(max_pack_size * (8 / microframes));
+            fs.interval = 1;
+        }
+        else {
+            fs.interval = microframes / 8 > 255 ? 255 : static_cast<uint8_t>(microframes / 8);
+        }
+        break;
+    }
+    case TransferType::Isochronous: {
+        if (interval == 0 || interval > 16) {
+            throw "invalid high speed interval";
+        }
+        uint32_t microframes = uint32_t{1} << (interval - 1);
+        if (microframes < 8) {
+            fs.max_pack_size = static_cast<uint16_t>(max_pack_size * (8 / microframes));
+            fs.interval = 1;
+        }
+        else {
+            fs.interval = interval - 3;
+        }
+        break;
+    }
+    }
+    if (fs.max_pack_size > MaxPacketSizeLimit(type, Speed::Full)) {
+        throw "endpoint does not fit in full speed, give a FullSpeedEndpoint for it";
+    }
+    return fs;
+}
+
+/*
+ * @char_array is the high speed form, the full speed form is @char_array with @patches applied
+ * GET_DESCRIPTOR(CONFIGURATION) reads the form of the current speed,
+ * GET_DESCRIPTOR(OTHER_SPEED_CONFIGURATION) reads the other form with bDescriptorType 7
+*/
+template<size_t N, size_t NUM_PATCH>
+struct DualSpeedConfig {
+    static constexpr size_t len = N;
+    static constexpr size_t num_patch = NUM_PATCH;
+    CharArray<N> char_array;
+    std::array<SpeedPatch, NUM_PATCH> patches{};
+
+    // copy $n bytes from $offset of the $speed form, Full or High, see @MakeSuperSpeedConfig for Super
+    constexpr void Read(Speed speed, bool other_speed, size_t offset, uint8_t* out, size_t n) const {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = char_array[offset + i];
+        }
+        if (speed == Speed::Full) {
+            for (const auto& patch : patches) {
+                if (patch.offset >= offset && patch.offset < offset + n) {
+                    out[patch.offset - offset] = patch.value;
+                }
+            }
+        }
+        if (other_speed && offset <= IConfig::type_offset && offset + n > IConfig::type_offset) {
+            out[IConfig::type_offset - offset] = 7;
+        }
+    }
+
+    constexpr CharArray<N> Make(Speed speed, bool other_speed) const {
+        CharArray<N> out{};
+        Read(speed, other_speed, 0, out.desc, N);
+        return out;
+    }
+};
+
+// the endpoint bytes which differ in the full speed form, $out can be nullptr, returns the number of them
+template<size_t N_OVERRIDE>
+constexpr size_t CollectSpeedPatches(
+    const uint8_t* desc,
+    size_t len,
+    const std::array<FullSpeedEndpoint, N_OVERRIDE>& overrides,
+    SpeedPatch* out
+) {
+    size_t count = 0;
+    WalkDescriptors(desc, len, [&count, &overrides, desc, out](const DescriptorInfo& info) {
+        if (info.type != 5) {
+            return;
+        }
+        size_t offset = info.offset;
+        uint8_t address = desc[offset + IEndpoint::address_offset];
+        uint16_t max_pack_size = desc[offset + IEndpoint::max_pack_low_offset]
+            | (desc[offset + IEndpoint::max_pack_high_offset] << 8);
+        uint8_t interval = desc[offset + IEndpoint::interval_offset];
+
+        bool found = false;
+        FullSpeedEndpoint fs{};
+        for (const auto& o : overrides) {
+            if (o.address == address) {
+                fs = o;
+                found = true;
+            }
+        }
+        if (!found) {
+            fs = DeriveFullSpeedEndpoint(address, static_cast<TransferType>(info.transfer_type), max_pack_size, interval);
+        }
+        else if (fs.max_pack_size > MaxPacketSizeLimit(static_cast<TransferType>(info.transfer_type), Speed::Full)) {
+            throw "max_pack_size is too large for the speed";
+        }
+        const SpeedPatch patches[] = {
+            SpeedPatch{static_cast<uint16_t>(offset + IEndpoint::max_pack_low_offset), static_cast<uint8_t>(fs.max_pack_size & 0xff)},
+            SpeedPatch{static_cast<uint16_t>(offset + IEndpoint::max_pack_high_offset), static_cast<uint8_t>(fs.max_pack_size >> 8)},
+            SpeedPatch{static_cast<uint16_t>(offset + IEndpoint::interval_offset), fs.interval}
+        };
+        for (const auto& patch : patches) {
+            if (desc[patch.offset] != patch.value) {
+                if (out != nullptr) {
+                    out[count] = patch;
+                }
+                ++count;
+            }
+        }
+    });
+    return count;
+}
+
+inline constexpr std::array<FullSpeedEndpoint, 0> no_full_speed_endpoint{};
+
+/*
+ * $CONFIG is a static constexpr @Config declared for high speed
+ * $OVERRIDES is a static constexpr std::array of @FullSpeedEndpoint, the patch table has just the bytes which differ
+ * eg. static constexpr std::array fs_endpoints{FullSpeedEndpoint{0x01, 392, 1}};
+ *     static constexpr auto dual = MakeDualSpeedConfig<config, fs_endpoints>();
+*/
+template<const auto& CONFIG, const auto& OVERRIDES = no_full_speed_endpoint>
+constexpr auto MakeDualSpeedConfig() {
+    constexpr const uint8_t* desc = CONFIG.char_array.desc;
+    constexpr size_t len = CONFIG.char_array.desc_len;
+    constexpr size_t num_patch = CollectSpeedPatches(desc, len, OVERRIDES, nullptr);
+
+    DualSpeedConfig<len, num_patch> config{};
+    config.char_array.Copy(0, CONFIG.char_array);
+    CollectSpeedPatches(desc, len, OVERRIDES, config.patches.data());
+    return config;
+}
+
+// --------------------------------------------------------------------------------
+// SUPER SPEED
+// the high speed @Config with a @SuperSpeedCompanion after every endpoint
+// --------------------------------------------------------------------------------
+
+// the super speed form of an endpoint when the derived one is not wanted
+struct SuperSpeedEndpoint {
+    uint8_t address;
+    uint16_t max_pack_size;
+    uint8_t max_burst;
+    // max streams of bulk, mult of isochronous, see @LegalCompanionAttribute
+    uint8_t attribute;
+    uint16_t bytes_per_interval;
+};
+
+/*
+ * bulk and control take the largest packet, periodic endpoints keep their bytes per interval
+ * and more than 1024 bytes are sent as a burst of 1024 bytes packets
+*/
+constexpr SuperSpeedEndpoint DeriveSuperSpeedEndpoint(uint8_t address, TransferType type, uint16_t max_pack_size) {
+    SuperSpeedEndpoint ss{address, max_pack_size, 0, 0, 0};
+    switch (type) {
+    case TransferType::Control:
+    case TransferType::Bulk:
+        ss.max_pack_size = MaxPacketSizeLimit(type, Speed::Super);
+        break;
+    case TransferType::Interrupt:
+    case TransferType::Isochronous: {
+        // bits 11-12 are the additional transactions of a high speed high bandwidth endpoint
+        uint32_t bytes = (max_pack_size & 0x7ff) * ((max_pack_size >> 11) + 1);
+        if (bytes > 1024) {
+            ss.max_pack_size = 1024;
+            ss.max_burst = static_cast<uint8_t>((bytes + 1023) / 1024 - 1);
+        }
+        else {
+            ss.max_pack_size = static_cast<uint16_t>(bytes);
+        }
+        ss.bytes_per_interval = static_cast<uint16_t>(bytes);
+        break;
+    }
+    }
+    return ss;
+}
+
+// number of endpoints not followed by a @SuperSpeedCompanion yet
+constexpr size_t CountEndpointWithoutCompanion(const uint8_t* desc, size_t len) {
+    size_t count = 0;
+    WalkDescriptors(desc, len, [desc, len, &count](const DescriptorInfo& info) {
+        size_t next = info.offset + info.length;
+        if (info.type == 5 && (next + 1 >= len || desc[next + 1] != 0x30)) {
+            ++count;
+        }
+    });
+    return count;
+}
+
+template<size_t N>
+struct SuperSpeedConfig {
+    static constexpr size_t len = N;
+    CharArray<N> char_array;
+};
+
+// $CONFIG is a static constexpr @Config, the endpoints already followed by a companion are copied as is
+template<const auto& CONFIG, size_t N_OVERRIDE = 0>
+constexpr auto MakeSuperSpeedConfig(const std::array<SuperSpeedEndpoint, N_OVERRIDE>& overrides = {}) {
+    constexpr const uint8_t* desc = CONFIG.char_array.desc;
+    constexpr size_t len = CONFIG.char_array.desc_len;
+    constexpr size_t ss_len = len + CountEndpointWithoutCompanion(desc, len) * SuperSpeedCompanion::len;
+    static_assert(ss_len <= 0xffff, "config too long");
+
+    SuperSpeedConfig<ss_len> config{};
+    size_t out = 0;
+    WalkDescriptors(desc, len, [&config, &out, &overrides, desc, len](const DescriptorInfo& info) {
+        for (size_t i = 0; i < info.length; ++i) {
+            config.char_array[out + i] = desc[info.offset + i];
+        }
+        size_t endpoint = out;
+        out += info.length;
+
+        size_t next = info.offset + info.length;
+        if (info.type != 5 || (next + 1 < len && desc[next + 1] == 0x30)) {
+            return;
+        }
+        auto type = static_cast<TransferType>(info.transfer_type);
+        uint8_t address = desc[info.offset + IEndpoint::address_offset];
+        uint16_t max_pack_size = desc[info.offset + IEndpoint::max_pack_low_offset]
+            | (desc[info.offset + IEndpoint::max_pack_high_offset] << 8);
+
+        SuperSpeedEndpoint ss = DeriveSuperSpeedEndpoint(address, type, max_pack_size);
+        for (const auto& o : overrides) {
+            if (o.address == address) {
+                ss = o;
+            }
+        }
+        if (ss.max_pack_size > MaxPacketSizeLimit(type, Speed::Super)) {
+            throw "max_pack_size is too large for the speed";
+        }
+        if (!LegalCompanionAttribute(type, ss.attribute)) {
+            throw "attribute is max streams up to 16 for bulk, mult up to 2 for isochronous and 0 otherwise";
+        }
+        config.char_array[endpoint + IEndpoint::max_pack_low_offset] = ss.max_pack_size & 0xff;
+        config.char_array[endpoint + IEndpoint::max_pack_high_offset] = ss.max_pack_size >> 8;
+        out = config.char_array.Copy(out, SuperSpeedCompanion{ss.max_burst, ss.attribute, ss.bytes_per_interval}.char_array);
+    });
+    config.char_array[IConfig::total_len_offset] = ss_len & 0xff;
+    config.char_array[IConfig::total_len_offset + 1] = ss_len >> 8;
+    return config;
+}
@@ -0,0 +1,183 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// --------------------------------------------------------------------------------
+// EP0
+// the data stage of GET_DESCRIPTOR, packets point into the descriptor itself,
+// only descriptors produced while read (eg. @PackedUSBString) go through a packet buffer
+// --------------------------------------------------------------------------------
+
+struct Ep0Packet {
+    const uint8_t* data = nullptr;
+    uint16_t len = 0;
+};
+
+struct Ep0Source {
+    const uint8_t* data = nullptr;
+    // instead of $data, copy up to $n bytes from $offset and return the number copied
+    size_t (*read)(size_t offset, uint8_t* out, size_t n) = nullptr;
+    uint16_t len = 0;
+};
+
+constexpr Ep0Source MakeSource(const uint8_t* data, uint16_t len) {
+    return Ep0Source{data, nullptr, len};
+}
+
+namespace internal {
+
+template<class DESC, class = void>
+struct HasCharArray : std::false_type {};
+template<class DESC>
+struct HasCharArray<DESC, std::void_t<decltype(std::declval<const DESC&>().char_array.desc)>> : std::true_type {};
+
+// a finalized descriptor, the @CharArray itself
+template<class DESC, class = void>
+struct IsFinalized : std::false_type {};
+template<class DESC>
+struct IsFinalized<DESC, std::void_t<decltype(DESC::desc_len), decltype(std::declval<const DESC&>().desc)>> : std::true_type {};
+
+// the bytes of a descriptor which holds them
+template<class DESC>
+constexpr const uint8_t* SourceBytes(const DESC& desc) {
+    if constexpr (IsFinalized<DESC>::value) {
+        return desc.desc;
+    }
+    else {
+        return desc.char_array.desc;
+    }
+}
+
+template<class DESC>
+constexpr size_t SourceLen() {
+    if constexpr (IsFinalized<DESC>::value) {
+        return DESC::desc_len;
+    }
+    else {
+        return DESC::len;
+    }
+}
+
+// $ARGS go before the offset, eg. the speed of @DualSpeedConfig::Read
+template<const auto& DESC, auto... ARGS>
+constexpr size_t ReadDescriptor(size_t offset, uint8_t* out, size_t n) {
+    if constexpr (std::is_void_v<decltype(DESC.Read(ARGS..., offset, out, n))>) {
+        DESC.Read(ARGS..., offset, out, n);
+        return n;
+    }
+    else {
+        return DESC.Read(ARGS..., offset, out, n);
+    }
+}
+
+}
+
+/*
+ * $DESC is a static constexpr descriptor or a finalized one, its bytes are sent as they are,
+ * or it has a Read(ARGS..., offset, out, n) producing them
+ * eg. MakeSource<config>(), MakeSource<finalized_config>(), MakeSource<packed_str>(), MakeSource<dual_config, Speed::Full, true>()
+*/
+template<const auto& DESC, auto... ARGS>
+constexpr Ep0Source MakeSource() {
+    using Desc = std::remove_cv_t<std::remove_reference_t<decltype(DESC)>>;
+    constexpr size_t len = internal::SourceLen<Desc>();
+    static_assert(len <= 0xffff, "descriptor too long");
+    if constexpr (sizeof...(ARGS) == 0 && (internal::HasCharArray<Desc>::value || internal::IsFinalized<Desc>::value)) {
+        return Ep0Source{internal::SourceBytes(DESC), nullptr, static_cast<uint16_t>(len)};
+    }
+    else {
+        return Ep0Source{nullptr, &internal::ReadDescriptor<DESC, ARGS...>, static_cast<uint16_t>(len)};
+    }
+}
+
+/*
+ * sends min(len, wLength) bytes in max_pack_size0 packets
+ * a zero length packet ends the stage when less than wLength is sent and the last packet is full
+*/
+struct Ep0InTransfer {
+    Ep0Source source;
+    uint8_t* buffer = nullptr;
+    uint16_t offset = 0;
+    uint16_t total = 0;
+    uint16_t max_pack_size0 = 64;
+    bool zlp = false;
+    bool done = true;
+
+    // $buffer of $max_pack_size0 bytes is only used by a source with read,
+    // false and no packet for a zero $mps0 or a source with read but no $packet_buffer
+    constexpr bool Start(const Ep0Source& src, uint16_t w_length, uint16_t mps0, uint8_t* packet_buffer = nullptr) {
+        if (mps0 == 0 || (src.read != nullptr && packet_buffer == nullptr)) {
+            done = true;
+            return false;
+        }
+        source = src;
+        buffer = packet_buffer;
+        offset = 0;
+        total = src.len < w_length ? src.len : w_length;
+        max_pack_size0 = mps0;
+        zlp = total < w_length && total % mps0 == 0;
+        done = false;
+        return true;
+    }
+
+    // the next packet of the data stage, false when the stage is over
+    constexpr bool Next(Ep0Packet& packet) {
+        if (done) {
+            return false;
+        }
+        uint16_t remain = total - offset;
+        if (remain == 0 && !zlp) {
+            done = true;
+            return false;
+        }
+        uint16_t len = remain < max_pack_size0 ? remain : max_pack_size0;
+        if (source.read != nullptr) {
+            source.read(offset, buffer, len);
+            packet = Ep0Packet{buffer, len};
+        }
+        else {
+            packet = Ep0Packet{source.data + offset, len};
+        }
+        offset += len;
+        if (len < max_pack_size0) {
+            // a short packet, the zero length one included, ends the stage
+            done = true;
+        }
+        return true;
+    }
+};
+
+/*
+ * glue to the controller, $HW is an object with
+ *
+ * void Send(const uint8_t* data, uint16_t len)   arm EP0 IN with $len bytes, $data may be in flash
+ * void Stall()
+ *
+ * call Start on GET_DESCRIPTOR and OnInComplete on every EP0 IN interrupt
+*/
+template<class HW, uint16_t MAX_PACK_SIZE0 = 64>
+struct Ep0Sender {
+    HW& hw;
+    Ep0InTransfer transfer{};
+    uint8_t buffer[MAX_PACK_SIZE0]{};
+
+    constexpr Ep0Sender(HW& hardware) : hw(hardware) {}
+
+    // a source of 0 bytes is an unknown descriptor
+    constexpr void Start(const Ep0Source& source, uint16_t w_length, uint16_t max_pack_size0 = MAX_PACK_SIZE0) {
+        if (source.len == 0 || max_pack_size0 > MAX_PACK_SIZE0
+            || !transfer.Start(source, w_length, max_pack_size0, buffer)) {
+            hw.Stall();
+            return;
+        }
+        OnInComplete();
+    }
+
+    constexpr void OnInComplete() {
+        Ep0Packet packet;
+        if (transfer.Next(packet)) {
+            hw.Send(packet.data, packet.len);
+        }
+    }
+};
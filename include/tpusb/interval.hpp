@@ -0,0 +1,44 @@
+#pragma once
+#include "usb.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// --------------------------------------------------------------------------------
+// INTERVAL
+// std::chrono service periods for the init packs and the service period of a bInterval
+// full speed interrupt counts frames, full speed isochronous 2^(n-1) frames,
+// high and super speed interrupt and isochronous 2^(n-1) microframes
+// --------------------------------------------------------------------------------
+
+// lets @Interval take a std::chrono::duration, eg. .interval = 1ms
+template<class REP, class PERIOD>
+struct IntervalPeriodTraits<std::chrono::duration<REP, PERIOD>> {
+    static constexpr uint32_t Microseconds(const std::chrono::duration<REP, PERIOD>& period) {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(period).count());
+    }
+};
+
+// bInterval of the longest service period not above $period
+template<class REP, class PERIOD>
+constexpr uint8_t EncodeInterval(TransferType type, Speed speed, std::chrono::duration<REP, PERIOD> period) {
+    return EncodeInterval(type, speed, IntervalPeriodTraits<std::chrono::duration<REP, PERIOD>>::Microseconds(period));
+}
+
+// the service period of a bInterval in microseconds
+constexpr std::chrono::microseconds ServicePeriod(TransferType type, Speed speed, uint8_t interval) {
+    if (type != TransferType::Interrupt && type != TransferType::Isochronous) {
+        throw "only interrupt and isochronous endpoint have a service period";
+    }
+    if (speed == Speed::Full && type == TransferType::Interrupt) {
+        if (interval == 0) {
+            throw "invalid full speed interrupt interval";
+        }
+        return std::chrono::microseconds{1000 * interval};
+    }
+    if (interval == 0 || interval > 16) {
+        throw "invalid interval";
+    }
+    int64_t unit = speed == Speed::Full ? 1000 : 125;
+    return std::chrono::microseconds{unit << (interval - 1)};
+}
@@ -0,0 +1,295 @@
+#pragma once
+#include "usb.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// --------------------------------------------------------------------------------
+// LAYOUT
+// every sub descriptor of a serialized configuration, and the byte statistics
+// the functions take a pointer, so the host tools can run them on plain bytes too
+// --------------------------------------------------------------------------------
+
+inline constexpr uint8_t no_interface = 0xff;
+inline constexpr uint8_t no_transfer_type = 0xff;
+
+struct DescriptorInfo {
+    uint16_t offset;
+    uint8_t length;
+    uint8_t type;
+    // the 3rd byte, only meaningful for class specific descriptors
+    uint8_t subtype;
+    // interface the descriptor belongs to, @no_interface before the first one
+    uint8_t interface_no;
+    uint8_t alter;
+    // interface class, or the function class of an interface association
+    uint8_t interface_class;
+    // @TransferType of an endpoint and of the class specific endpoint descriptors after it
+    uint8_t transfer_type;
+};
+
+// call $f with a @DescriptorInfo of every descriptor, return the number of descriptors
+template<class F>
+constexpr size_t WalkDescriptors(const uint8_t* desc, size_t len, F&& f) {
+    size_t count = 0;
+    size_t offset = 0;
+    uint8_t interface_no = no_interface;
+    uint8_t alter = 0;
+    uint8_t interface_class = 0;
+    uint8_t transfer_type = no_transfer_type;
+
+    while (offset < len) {
+        uint8_t desc_len = desc[offset];
+        if (desc_len < 2 || offset + desc_len > len) {
+            throw "broken descriptor";
+        }
+        uint8_t type = desc[offset + 1];
+
+        switch (type) {
+        case 4:
+            interface_no = desc[offset + IInterface::interface_no_offset];
+            alter = desc[offset + IInterface::alter_offset];
+            interface_class = desc[offset + IInterface::class_offset];
+            transfer_type = no_transfer_type;
+            break;
+        case 5:
+            transfer_type = desc[offset + IEndpoint::attribute_offset] & 0x3;
+            break;
+        case 0xb:
+            interface_no = desc[offset + IInterfaceAssociation::first_interface_offset];
+            alter = 0;
+            interface_class = desc[offset + 4];
+            transfer_type = no_transfer_type;
+            break;
+        case 0x25:
+        case 0x30:
+            // class specific endpoint and super speed companion keep the transfer type of its endpoint
+            break;
+        default:
+            transfer_type = no_transfer_type;
+            break;
+        }
+
+        f(DescriptorInfo{
+            static_cast<uint16_t>(offset),
+            desc_len,
+            type,
+            desc_len > 2 ? desc[offset + 2] : uint8_t{0},
+            interface_no,
+            alter,
+            interface_class,
+            transfer_type
+        });
+        offset += desc_len;
+        ++count;
+    }
+    return count;
+}
+
+struct DescriptorStats {
+    uint16_t total_len = 0;
+    uint16_t num_descriptor = 0;
+    uint8_t num_interface = 0;
+    uint8_t num_endpoint = 0;
+    // bytes of the interfaces of each class, including their iad and endpoints
+    uint16_t class_bytes[256]{};
+    // bytes of each interface number, all alternate settings included
+    uint16_t interface_bytes[256]{};
+    // bytes and count of the endpoints of each @TransferType, class specific endpoint descriptors included
+    uint16_t transfer_type_bytes[4]{};
+    uint8_t transfer_type_count[4]{};
+
+    // number of data packets the host needs to read the whole descriptor from EP0,
+    // $max_pack_size0 in bytes, 512 at super speed, see @MaxPacketSize0
+    constexpr uint16_t Ep0Packets(uint16_t max_pack_size0) const {
+        if (max_pack_size0 == 0) {
+            throw "max_pack_size0 can not be 0";
+        }
+        return (total_len + max_pack_size0 - 1) / max_pack_size0;
+    }
+};
+
+constexpr DescriptorStats MakeDescriptorStats(const uint8_t* desc, size_t len) {
+    DescriptorStats stats;
+    stats.total_len = static_cast<uint16_t>(len);
+    stats.num_descriptor = static_cast<uint16_t>(WalkDescriptors(desc, len, [&stats](const DescriptorInfo& info) {
+        if (info.type == 4 && info.alter == 0) {
+            ++stats.num_interface;
+        }
+        if (info.type == 5) {
+            ++stats.num_endpoint;
+            ++stats.transfer_type_count[info.transfer_type];
+        }
+        if (info.interface_no != no_interface) {
+            stats.class_bytes[info.interface_class] += info.length;
+            stats.interface_bytes[info.interface_no] += info.length;
+        }
+        if (info.transfer_type != no_transfer_type) {
+            stats.transfer_type_bytes[info.transfer_type] += info.length;
+        }
+    }));
+    return stats;
+}
+
+template<size_t NUM_DESCRIPTOR>
+struct DescriptorLayout {
+    static constexpr size_t size = NUM_DESCRIPTOR;
+    DescriptorInfo entries[NUM_DESCRIPTOR]{};
+    DescriptorStats stats;
+
+    constexpr const DescriptorInfo& operator[](size_t i) const {
+        return entries[i];
+    }
+};
+
+template<const auto& DESC>
+constexpr auto MakeDescriptorLayout() {
+    constexpr const uint8_t* desc = DESC.char_array.desc;
+    constexpr size_t len = DESC.char_array.desc_len;
+    constexpr size_t num_descriptor = WalkDescriptors(desc, len, [](const DescriptorInfo&) {});
+
+    DescriptorLayout<num_descriptor> layout;
+    size_t i = 0;
+    WalkDescriptors(desc, len, [&layout, &i](const DescriptorInfo& info) {
+        layout.entries[i++] = info;
+    });
+    layout.stats = MakeDescriptorStats(desc, len);
+    return layout;
+}
+
+// the layout map of a static constexpr @Config, eg. descriptor_layout<config>[3].offset
+template<const auto& DESC>
+inline constexpr auto descriptor_layout = MakeDescriptorLayout<DESC>();
+
+// --------------------------------------------------------------------------------
+// ENDPOINT TABLE
+// every endpoint of a config in descriptor order, so SET_CONFIGURATION and SET_INTERFACE
+// open the endpoints with a table walk instead of parsing the descriptor
+// --------------------------------------------------------------------------------
+
+struct EndpointInfo {
+    uint8_t interface_no;
+    uint8_t alter;
+    uint8_t address;
+    TransferType type;
+    // only meaningful for isochronous endpoints
+    SynchronousType sync_type;
+    IsoEpType endpoint_type;
+    // bits 0-10 of wMaxPacketSize
+    uint16_t max_pack_size;
+    // 1 to 3 packets per microframe
+    uint8_t transactions;
+    uint8_t interval;
+};
+
+// endpoints[first] to endpoints[first + count - 1] belong to the alternate setting
+struct AlternateEndpoints {
+    uint8_t interface_no;
+    uint8_t alter;
+    uint8_t first;
+    uint8_t count;
+};
+
+template<size_t NUM_ENDPOINT, size_t NUM_ALTERNATE, size_t NUM_INTERFACE>
+struct EndpointTable {
+    static constexpr size_t num_endpoint = NUM_ENDPOINT;
+    static constexpr size_t num_alternate = NUM_ALTERNATE;
+    static constexpr size_t num_interface = NUM_INTERFACE;
+    EndpointInfo endpoints[NUM_ENDPOINT > 0 ? NUM_ENDPOINT : 1]{};
+    AlternateEndpoints alternates[NUM_ALTERNATE > 0 ? NUM_ALTERNATE : 1]{};
+    // index of alternate setting 0 of every interface in @alternates
+    uint8_t first_alternate[NUM_INTERFACE > 0 ? NUM_INTERFACE : 1]{};
+    // number of alternate settings of every interface, 0 for a number the config skips
+    uint8_t alternate_count[NUM_INTERFACE > 0 ? NUM_INTERFACE : 1]{};
+
+    // the config has the alternate setting, SET_INTERFACE STALLs otherwise
+    constexpr bool Contains(uint8_t interface_no, uint8_t alter) const {
+        return interface_no < NUM_INTERFACE && alter < alternate_count[interface_no];
+    }
+
+    // no endpoint for an alternate setting the config does not have
+    constexpr AlternateEndpoints Find(uint8_t interface_no, uint8_t alter) const {
+        if (!Contains(interface_no, alter)) {
+            return AlternateEndpoints{interface_no, alter, 0, 0};
+        }
+        return alternates[first_alternate[interface_no] + alter];
+    }
+
+    constexpr const EndpointInfo* begin(uint8_t interface_no, uint8_t alter) const {
+        return endpoints + Find(interface_no, alter).first;
+    }
+
+    constexpr const EndpointInfo* end(uint8_t interface_no, uint8_t alter) const {
+        AlternateEndpoints found = Find(interface_no, alter);
+        return endpoints + found.first + found.count;
+    }
+};
+
+template<const auto& CONFIG>
+constexpr auto MakeEndpointTable() {
+    constexpr const uint8_t* desc = CONFIG.char_array.desc;
+    constexpr size_t len = CONFIG.char_array.desc_len;
+    constexpr DescriptorStats stats = MakeDescriptorStats(desc, len);
+    constexpr size_t num_alternate = [] {
+        size_t count = 0;
+        WalkDescriptors(desc, len, [&count](const DescriptorInfo& info) {
+            count += info.type == 4 ? 1 : 0;
+        });
+        return count;
+    }();
+    constexpr size_t num_interface = [] {
+        size_t count = 0;
+        WalkDescriptors(desc, len, [&count](const DescriptorInfo& info) {
+            if (info.type == 4 && info.interface_no >= count) {
+                count = info.interface_no + 1;
+            }
+        });
+        return count;
+    }();
+
+    EndpointTable<stats.num_endpoint, num_alternate, num_interface> table;
+    size_t num_endpoint = 0;
+    size_t alternate = 0;
+    WalkDescriptors(desc, len, [&](const DescriptorInfo& info) {
+        if (info.type == 4) {
+            if (info.alter == 0) {
+                if (table.alternate_count[info.interface_no] != 0) {
+                    throw "interface number used twice";
+                }
+                table.first_alternate[info.interface_no] = static_cast<uint8_t>(alternate);
+            }
+            else if (info.alter != table.alternate_count[info.interface_no]
+                || alternate != table.first_alternate[info.interface_no] + info.alter) {
+                throw "alternate settings of an interface must be numbered in order";
+            }
+            ++table.alternate_count[info.interface_no];
+            table.alternates[alternate++] = AlternateEndpoints{
+                info.interface_no, info.alter, static_cast<uint8_t>(num_endpoint), 0
+            };
+        }
+        else if (info.type == 5) {
+            if ((desc[info.offset + IEndpoint::address_offset] & 0xf) == 0) {
+                throw "endpoint address not allocated, see AllocateEndpointAddress";
+            }
+            uint8_t attribute = desc[info.offset + IEndpoint::attribute_offset];
+            uint16_t max_pack_size = desc[info.offset + IEndpoint::max_pack_low_offset]
+                | (desc[info.offset + IEndpoint::max_pack_high_offset] << 8);
+            table.endpoints[num_endpoint++] = EndpointInfo{
+                info.interface_no,
+                info.alter,
+                desc[info.offset + IEndpoint::address_offset],
+                static_cast<TransferType>(attribute & 0x3),
+                static_cast<SynchronousType>((attribute >> 2) & 0x3),
+                static_cast<IsoEpType>((attribute >> 4) & 0x3),
+                static_cast<uint16_t>(max_pack_size & 0x7ff),
+                static_cast<uint8_t>(((max_pack_size >> 11) & 0x3) + 1),
+                desc[info.offset + IEndpoint::interval_offset]
+            };
+            ++table.alternates[alternate - 1].count;
+        }
+    });
+    return table;
+}
+
+// eg. for (auto ep = table.begin(1, 1); ep != table.end(1, 1); ++ep) OpenEndpoint(*ep);
+template<const auto& CONFIG>
+inline constexpr auto endpoint_table = MakeEndpointTable<CONFIG>();
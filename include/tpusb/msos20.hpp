@@ -0,0 +1,271 @@
+#pragma once
+#include "usb.hpp"
+#include "usb_str.hpp"
+#include "layout.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// --------------------------------------------------------------------------------
+// BOS
+// the device must report bcd_usb 0x0210 or later, or the host will not ask for it
+// --------------------------------------------------------------------------------
+
+struct USB20Extension {
+    static constexpr size_t len = 7;
+    CharArray<len> char_array {
+        len,
+        0x10,
+        0x02
+    };
+
+    // bit 1 is LPM
+    constexpr USB20Extension(uint32_t attribute) {
+        char_array[3] = attribute & 0xff;
+        char_array[4] = (attribute >> 8) & 0xff;
+        char_array[5] = (attribute >> 16) & 0xff;
+        char_array[6] = attribute >> 24;
+    }
+};
+
+// 1. any device capability, eg. @USB20Extension, @MSOS20Platform or a @CustomDesc
+template<class... DESCS>
+struct BOS {
+    static constexpr size_t len = DESC_LEN_SUMMER<DESCS...>::len + 5;
+    CharArray<len> char_array {
+        5,
+        0x0f
+    };
+
+    constexpr BOS(const DESCS&... desc) {
+        char_array[2] = len & 0xff;
+        char_array[3] = len >> 8;
+        char_array[4] = sizeof...(DESCS);
+
+        size_t offset = 5;
+        ((offset = SerializeDesc(desc, char_array, offset)),...);
+    }
+};
+
+// --------------------------------------------------------------------------------
+// MS OS 2.0
+// windows reads the descriptor set with a vendor request, wIndex 7
+// --------------------------------------------------------------------------------
+
+inline constexpr uint32_t windows_8_1 = 0x06030000;
+
+struct IMSOS20FunctionSubset {
+    static constexpr size_t first_interface_offset = 4;
+};
+
+// 1. the first interface of the function, the first interface of its @InterfaceAssociation if it has one
+// 2. any feature descriptor, eg. @MSOS20CompatibleId, @MSOS20RegistryProperty
+template<class... DESCS>
+struct MSOS20FunctionSubset : public IMSOS20FunctionSubset, public INestedDesc {
+    static constexpr size_t header_len = 8;
+    static constexpr size_t len = DESC_LEN_SUMMER<DESCS...>::len + header_len;
+    CharArray<header_len> char_array {
+        header_len, 0,
+        0x02, 0
+    };
+    std::tuple<DESCS...> descs;
+
+    constexpr MSOS20FunctionSubset(uint8_t first_interface, const DESCS&... desc) : descs(desc...) {
+        char_array[4] = first_interface;
+        char_array[5] = 0;
+        char_array[6] = len & 0xff;
+        char_array[7] = len >> 8;
+    }
+
+    template<size_t N>
+    constexpr size_t Serialize(CharArray<N>& out, size_t offset) const {
+        return SerializeNested(char_array, descs, out, offset);
+    }
+};
+
+// true if $first_interface starts a function of the configuration descriptor
+template<size_t N>
+constexpr bool IsFunctionFirstInterface(const CharArray<N>& config, uint8_t first_interface) {
+    bool found = false;
+    uint8_t iad_first = 0;
+    uint8_t iad_end = 0;
+    WalkDescriptors(config.desc, N, [&](const DescriptorInfo& info) {
+        if (info.type == 0xb) {
+            iad_first = config[info.offset + IInterfaceAssociation::first_interface_offset];
+            iad_end = iad_first + config[info.offset + IInterfaceAssociation::first_interface_offset + 1];
+            found |= iad_first == first_interface;
+        }
+        else if (info.type == 4 && info.interface_no == first_interface
+            && (first_interface < iad_first || first_interface >= iad_end)) {
+            found = true;
+        }
+    });
+    return found;
+}
+
+// 1. the @Config the subset applies to, every function subset is checked against it
+// 2. any @MSOS20FunctionSubset or feature descriptor
+template<class CONFIG, class... DESCS>
+struct MSOS20ConfigurationSubset : public INestedDesc {
+    static constexpr size_t header_len = 8;
+    static constexpr size_t len = DESC_LEN_SUMMER<DESCS...>::len + header_len;
+    CharArray<header_len> char_array {
+        header_len, 0,
+        0x01, 0
+    };
+    std::tuple<DESCS...> descs;
+
+    constexpr MSOS20ConfigurationSubset(const CONFIG& config, const DESCS&... desc) : descs(desc...) {
+        // windows takes it as the index of the configuration, bConfigurationValue - 1
+        char_array[4] = config.char_array[5] - 1;
+        char_array[5] = 0;
+        char_array[6] = len & 0xff;
+        char_array[7] = len >> 8;
+        (CheckFunction(config, desc), ...);
+    }
+
+    template<class DESC>
+    static constexpr void CheckFunction(const CONFIG& config, const DESC& desc) {
+        if constexpr (std::is_base_of_v<IMSOS20FunctionSubset, DESC>) {
+            if (!IsFunctionFirstInterface(config.char_array, desc.char_array[IMSOS20FunctionSubset::first_interface_offset])) {
+                throw "function subset is not the first interface of a function of the config";
+            }
+        }
+    }
+
+    template<size_t N>
+    constexpr size_t Serialize(CharArray<N>& out, size_t offset) const {
+        return SerializeNested(char_array, descs, out, offset);
+    }
+};
+
+struct MSOS20CompatibleId {
+    static constexpr size_t len = 20;
+    CharArray<len> char_array {
+        len, 0,
+        0x03, 0
+    };
+
+    // eg. "WINUSB"
+    template<size_t N1, size_t N2 = 1>
+    constexpr MSOS20CompatibleId(const char (&compatible_id)[N1], const char (&sub_compatible_id)[N2] = "") {
+        static_assert(N1 <= 9 && N2 <= 9, "compatible id is up to 8 characters");
+        for (size_t i = 0; i + 1 < N1; ++i) {
+            char_array[4 + i] = compatible_id[i];
+        }
+        for (size_t i = 0; i + 1 < N2; ++i) {
+            char_array[12 + i] = sub_compatible_id[i];
+        }
+    }
+};
+
+enum class RegistryType : uint16_t {
+    Sz = 1,
+    ExpandSz = 2,
+    Binary = 3,
+    DwordLittleEndian = 4,
+    DwordBigEndian = 5,
+    Link = 6,
+    MultiSz = 7
+};
+
+// the utf16 characters of a @USBString and $num_null utf16 '\0'
+template<size_t NUM_NULL, size_t N>
+constexpr CharArray<N - 2 + NUM_NULL * 2> RegistryString(const USBString<N>& str) {
+    CharArray<N - 2 + NUM_NULL * 2> out{};
+    for (size_t i = 2; i < N; ++i) {
+        out[i - 2] = str.char_array[i];
+    }
+    return out;
+}
+
+// 1. the registry type of the data
+// 2. the name, eg. USB_STR(u8"DeviceInterfaceGUIDs")
+// 3. the data, eg. RegistryString<2>(USB_STR(u8"{...}")) for RegistryType::MultiSz
+template<size_t NAME_N, size_t DATA_N>
+struct MSOS20RegistryProperty {
+    static constexpr size_t len = 10 + NAME_N + DATA_N;
+    CharArray<len> char_array {
+        len & 0xff, len >> 8,
+        0x04, 0
+    };
+
+    constexpr MSOS20RegistryProperty(RegistryType type, const CharArray<NAME_N>& name, const CharArray<DATA_N>& data) {
+        char_array[4] = static_cast<uint16_t>(type) & 0xff;
+        char_array[5] = static_cast<uint16_t>(type) >> 8;
+        char_array[6] = NAME_N & 0xff;
+        char_array[7] = NAME_N >> 8;
+        size_t offset = char_array.Copy(8, name);
+        char_array[offset] = DATA_N & 0xff;
+        char_array[offset + 1] = DATA_N >> 8;
+        char_array.Copy(offset + 2, data);
+    }
+};
+
+// the usual property of a WinUSB function, $guid is like USB_STR(u8"{975F44D9-0D08-43FD-8B3E-127CA8AFFF9D}")
+template<size_t N>
+constexpr auto MSOS20DeviceInterfaceGUIDs(const USBString<N>& guid) {
+    return MSOS20RegistryProperty{
+        RegistryType::MultiSz,
+        RegistryString<1>(USB_STR(u8"DeviceInterfaceGUIDs")),
+        RegistryString<2>(guid)
+    };
+}
+
+struct MSOS20SetInitPack {
+    // bRequest of the vendor request reading the set
+    uint8_t vendor_code;
+    uint32_t windows_version = windows_8_1;
+};
+
+// 1. one @MSOS20SetInitPack
+// 2. any @MSOS20ConfigurationSubset or feature descriptor
+template<class... DESCS>
+struct MSOS20DescriptorSet {
+    static constexpr size_t len = DESC_LEN_SUMMER<DESCS...>::len + 10;
+    CharArray<len> char_array {
+        10, 0,
+        0x00, 0
+    };
+    uint8_t vendor_code;
+    uint32_t windows_version;
+
+    constexpr MSOS20DescriptorSet(MSOS20SetInitPack pack, const DESCS&... desc)
+        : vendor_code(pack.vendor_code), windows_version(pack.windows_version) {
+        static_assert(len <= 0xffff, "descriptor set too long");
+        char_array[4] = pack.windows_version & 0xff;
+        char_array[5] = (pack.windows_version >> 8) & 0xff;
+        char_array[6] = (pack.windows_version >> 16) & 0xff;
+        char_array[7] = pack.windows_version >> 24;
+        char_array[8] = len & 0xff;
+        char_array[9] = len >> 8;
+
+        size_t offset = 10;
+        ((offset = SerializeDesc(desc, char_array, offset)),...);
+    }
+};
+
+// the BOS platform capability pointing to a @MSOS20DescriptorSet, length and vendor code are taken from it
+struct MSOS20Platform {
+    static constexpr size_t len = 28;
+    CharArray<len> char_array {
+        len,
+        0x10,
+        0x05,
+        0,
+        // D8DD60DF-4589-4CC7-9CD2-659D9E648A9F
+        0xdf, 0x60, 0xdd, 0xd8, 0x89, 0x45, 0xc7, 0x4c,
+        0x9c, 0xd2, 0x65, 0x9d, 0x9e, 0x64, 0x8a, 0x9f
+    };
+
+    template<class... DESCS>
+    constexpr MSOS20Platform(const MSOS20DescriptorSet<DESCS...>& set) {
+        char_array[20] = set.windows_version & 0xff;
+        char_array[21] = (set.windows_version >> 8) & 0xff;
+        char_array[22] = (set.windows_version >> 16) & 0xff;
+        char_array[23] = set.windows_version >> 24;
+        char_array[24] = set.len & 0xff;
+        char_array[25] = set.len >> 8;
+        char_array[26] = set.vendor_code;
+        char_array[27] = 0;
+    }
+};
@@ -0,0 +1,130 @@
+#pragma once
+#include "usb.hpp"
+#include "ep0.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// --------------------------------------------------------------------------------
+// PATCH
+// bytes of a finalized descriptor only known at boot, eg. the serial number from the chip UID,
+// bMaxPower from the power contract, a per unit product name
+// the descriptor stays in flash, only the patched bytes are in RAM and EP0 splices them in while sending
+// --------------------------------------------------------------------------------
+
+struct PatchSlot {
+    uint16_t offset;
+    uint16_t len;
+};
+
+// bMaxPower of a @Config
+inline constexpr PatchSlot max_power_slot{IConfig::power_offset, 1};
+
+// $num_char utf16 code units of a string descriptor from the $first_char th,
+// the string of the descriptor is the placeholder, eg. USB_STR(u8"000000000000") for a 12 digit serial
+constexpr PatchSlot StringSlot(size_t first_char, size_t num_char) {
+    return PatchSlot{static_cast<uint16_t>(2 + first_char * 2), static_cast<uint16_t>(num_char * 2)};
+}
+
+namespace internal {
+
+// where each slot keeps its bytes in RAM, the last one is the number of them
+template<size_t N>
+constexpr std::array<size_t, N + 1> MakePatchOffsets(const std::array<PatchSlot, N>& slots, size_t desc_len) {
+    std::array<size_t, N + 1> offsets{};
+    for (size_t i = 0; i < N; ++i) {
+        if (slots[i].len == 0 || slots[i].offset + slots[i].len > desc_len) {
+            throw "patch slot out of the descriptor";
+        }
+        if (slots[i].offset < 2) {
+            throw "bLength and bDescriptorType can not be patched";
+        }
+        for (size_t j = 0; j < i; ++j) {
+            if (slots[i].offset < slots[j].offset + slots[j].len && slots[j].offset < slots[i].offset + slots[i].len) {
+                throw "patch slots overlap";
+            }
+        }
+        offsets[i + 1] = offsets[i] + slots[i].len;
+    }
+    return offsets;
+}
+
+}
+
+/*
+ * $DESC is a static constexpr descriptor or a finalized one, $SLOTS a static constexpr std::array of @PatchSlot
+ * a slot holds the bytes of $DESC until Set, send it by MakeSource<patched>()
+ *
+ * static constexpr std::array serial_slots{StringSlot(0, 12)};
+ * static PatchedDescriptor<serial, serial_slots> patched_serial;
+ * patched_serial.SetString(0, uid_hex);
+*/
+template<const auto& DESC, const auto& SLOTS>
+struct PatchedDescriptor {
+    using Desc = std::remove_cv_t<std::remove_reference_t<decltype(DESC)>>;
+    static constexpr size_t len = internal::SourceLen<Desc>();
+    static constexpr size_t num_slot = std::tuple_size_v<std::remove_cv_t<std::remove_reference_t<decltype(SLOTS)>>>;
+    static constexpr auto ram_offsets = internal::MakePatchOffsets(SLOTS, len);
+    static constexpr size_t ram_len = ram_offsets[num_slot];
+    uint8_t ram[ram_len > 0 ? ram_len : 1]{};
+
+    constexpr PatchedDescriptor() {
+        for (size_t i = 0; i < num_slot; ++i) {
+            for (size_t j = 0; j < SLOTS[i].len; ++j) {
+                ram[ram_offsets[i] + j] = internal::SourceBytes(DESC)[SLOTS[i].offset + j];
+            }
+        }
+    }
+
+    // the SLOTS[$slot].len bytes of $data
+    constexpr void Set(size_t slot, const uint8_t* data) {
+        for (size_t j = 0; j < SLOTS[slot].len; ++j) {
+            ram[ram_offsets[slot] + j] = data[j];
+        }
+    }
+
+    // an ascii $str widened to utf16 into a @StringSlot, the rest of the slot is padded with utf16 spaces
+    // so bLength of the placeholder stays right, false and the slot untouched if $str is not ascii or too long
+    constexpr bool SetString(size_t slot, const char* str) {
+        size_t n = 0;
+        for (; str[n] != '\0'; ++n) {
+            if (n == SLOTS[slot].len / 2 || static_cast<uint8_t>(str[n]) > 0x7f) {
+                return false;
+            }
+        }
+        for (size_t j = 0; j < SLOTS[slot].len / 2; ++j) {
+            ram[ram_offsets[slot] + j * 2] = j < n ? static_cast<uint8_t>(str[j]) : ' ';
+            ram[ram_offsets[slot] + j * 2 + 1] = 0;
+        }
+        return true;
+    }
+
+    // the $i th byte of the descriptor
+    constexpr uint8_t operator[](size_t i) const {
+        for (size_t slot = 0; slot < num_slot; ++slot) {
+            if (i >= SLOTS[slot].offset && i < SLOTS[slot].offset + SLOTS[slot].len) {
+                return ram[ram_offsets[slot] + i - SLOTS[slot].offset];
+            }
+        }
+        return internal::SourceBytes(DESC)[i];
+    }
+
+    // copy up to $n bytes of the descriptor from $offset, flash first then the slots over it
+    constexpr size_t Read(size_t offset, uint8_t* out, size_t n) const {
+        size_t count = offset < len ? len - offset : 0;
+        count = count < n ? count : n;
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = internal::SourceBytes(DESC)[offset + i];
+        }
+        for (size_t slot = 0; slot < num_slot; ++slot) {
+            size_t begin = SLOTS[slot].offset > offset ? SLOTS[slot].offset : offset;
+            size_t end = SLOTS[slot].offset + SLOTS[slot].len;
+            end = end < offset + count ? end : offset + count;
+            for (size_t i = begin; i < end; ++i) {
+                out[i - offset] = ram[ram_offsets[slot] + i - SLOTS[slot].offset];
+            }
+        }
+        return count;
+    }
+};
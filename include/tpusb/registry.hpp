@@ -0,0 +1,152 @@
+#pragma once
+#include "usb.hpp"
+#include "layout.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// --------------------------------------------------------------------------------
+// REGISTRY
+// GET_DESCRIPTOR(type, index, wIndex) to the bytes in constant time
+// the key hashes into a collision free slot table found at compile time, one compare tells hit or miss
+// --------------------------------------------------------------------------------
+
+constexpr uint32_t DescriptorKey(uint8_t type, uint8_t index, uint16_t w_index) {
+    return (uint32_t{type} << 24) | (uint32_t{index} << 16) | w_index;
+}
+
+struct DescriptorRef {
+    const uint8_t* data = nullptr;
+    uint16_t len = 0;
+};
+
+struct DescriptorEntry {
+    uint32_t key;
+    DescriptorRef ref;
+};
+
+// any descriptor with a header, the type is its 2nd byte, eg. device, config, string, BOS
+// $desc must be a static constexpr object
+template<class DESC>
+constexpr DescriptorEntry MakeEntry(const DESC& desc, uint8_t index = 0, uint16_t w_index = 0) {
+    return DescriptorEntry{
+        DescriptorKey(desc.char_array[1], index, w_index),
+        DescriptorRef{desc.char_array.desc, static_cast<uint16_t>(DESC::len)}
+    };
+}
+
+// bytes without a header, eg. a HID report descriptor
+template<size_t N>
+constexpr DescriptorEntry MakeEntry(uint8_t type, uint8_t index, uint16_t w_index, const uint8_t (&data)[N]) {
+    return DescriptorEntry{
+        DescriptorKey(type, index, w_index),
+        DescriptorRef{data, static_cast<uint16_t>(N)}
+    };
+}
+
+// the class descriptor of $type inside the interface $interface_no of $config, wIndex is the interface
+template<size_t N>
+constexpr DescriptorEntry MakeClassEntry(const CharArray<N>& config, uint8_t type, uint8_t interface_no) {
+    DescriptorEntry entry{DescriptorKey(type, 0, interface_no), DescriptorRef{}};
+    WalkDescriptors(config.desc, N, [&config, &entry, type, interface_no](const DescriptorInfo& info) {
+        if (info.type == type && info.interface_no == interface_no && info.alter == 0 && entry.ref.data == nullptr) {
+            entry.ref = DescriptorRef{config.desc + info.offset, info.length};
+        }
+    });
+    if (entry.ref.data == nullptr) {
+        throw "no such class descriptor in the interface";
+    }
+    return entry;
+}
+
+// the HID descriptor of the interface
+template<size_t N>
+constexpr DescriptorEntry MakeHidEntry(const CharArray<N>& config, uint8_t interface_no) {
+    return MakeClassEntry(config, 0x21, interface_no);
+}
+
+// the report descriptor of the interface, its length is checked against the HID descriptor
+template<size_t N, size_t REPORT_N>
+constexpr DescriptorEntry MakeHidReportEntry(const CharArray<N>& config, uint8_t interface_no, const uint8_t (&report)[REPORT_N]) {
+    DescriptorRef hid = MakeHidEntry(config, interface_no).ref;
+    for (size_t offset = 6; offset + 2 < hid.len; offset += 3) {
+        if (hid.data[offset] == 0x22 && (hid.data[offset + 1] | (hid.data[offset + 2] << 8)) != REPORT_N) {
+            throw "report length differs from the HID descriptor";
+        }
+    }
+    return MakeEntry(0x22, 0, interface_no, report);
+}
+
+template<size_t N>
+struct DescriptorRegistry {
+    static_assert(N > 0 && N < 0xff, "1 to 254 descriptors");
+    static constexpr size_t num_entry = N;
+    // a power of 2 not less than 4N keeps the search short
+    static constexpr size_t num_slot_bits = [] {
+        size_t bits = 0;
+        while ((size_t{1} << bits) < N * 4) {
+            ++bits;
+        }
+        return bits;
+    }();
+    static constexpr size_t num_slot = size_t{1} << num_slot_bits;
+
+    uint32_t multiplier = 0;
+    // index in @keys, an empty slot is the miss entry @num_entry
+    uint8_t slots[num_slot]{};
+    uint32_t keys[N + 1]{};
+    DescriptorRef refs[N + 1]{};
+
+    static constexpr uint32_t Slot(uint32_t key, uint32_t multiplier) {
+        return num_slot_bits == 0 ? 0 : static_cast<uint32_t>(key * multiplier) >> (32 - num_slot_bits);
+    }
+
+    // {nullptr, 0} for an unknown descriptor, STALL it
+    constexpr DescriptorRef Find(uint8_t type, uint8_t index, uint16_t w_index) const {
+        uint32_t key = DescriptorKey(type, index, w_index);
+        uint8_t i = slots[Slot(key, multiplier)];
+        return refs[keys[i] == key ? i : N];
+    }
+};
+
+// eg. MakeDescriptorRegistry(std::array{MakeEntry(device), MakeEntry(config), MakeEntry(str, 1, 0x0409)})
+template<size_t N>
+constexpr DescriptorRegistry<N> MakeDescriptorRegistry(const std::array<DescriptorEntry, N>& entries) {
+    using Registry = DescriptorRegistry<N>;
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = i + 1; j < N; ++j) {
+            if (entries[i].key == entries[j].key) {
+                throw "descriptor registered twice";
+            }
+        }
+    }
+
+    Registry registry;
+    // odd multipliers from a lcg until every key has its own slot
+    uint32_t multiplier = 0x9e3779b1;
+    for (size_t attempt = 0; attempt < 100000; ++attempt) {
+        bool collision = false;
+        bool used[Registry::num_slot]{};
+        for (size_t i = 0; i < N && !collision; ++i) {
+            uint32_t slot = Registry::Slot(entries[i].key, multiplier);
+            collision = used[slot];
+            used[slot] = true;
+        }
+        if (!collision) {
+            registry.multiplier = multiplier;
+            for (auto& slot : registry.slots) {
+                slot = N;
+            }
+            for (size_t i = 0; i < N; ++i) {
+                registry.slots[Registry::Slot(entries[i].key, multiplier)] = static_cast<uint8_t>(i);
+                registry.keys[i] = entries[i].key;
+                registry.refs[i] = entries[i].ref;
+            }
+            // no request has type 0, so the miss entry never matches
+            registry.keys[N] = 0;
+            return registry;
+        }
+        multiplier = (multiplier * 1664525u + 1013904223u) | 1u;
+    }
+    throw "no collision free hash found";
+}
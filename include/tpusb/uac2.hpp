@@ -16,32 +16,28 @@ struct AudioFunctionInitPack {
 // 1. one @AudioFunctionInitPack
 // 2. any AudioFunctions
 template<class... DESCS>
-struct AudioFunction {
-    static constexpr size_t len = DESC_LEN_SUMMER<DESCS...>::len + 9;
-    CharArray<len> char_array {
-        9,
+struct AudioFunction : public INestedDesc {
+    static constexpr size_t header_len = 9;
+    static constexpr size_t len = DESC_LEN_SUMMER<DESCS...>::len + header_len;
+    CharArray<header_len> char_array {
+        header_len,
         0x24,
         0x01
     };
-    size_t begin = 9;
+    std::tuple<DESCS...> descs;
 
-    constexpr AudioFunction(AudioFunctionInitPack pack, const DESCS&... desc) {
+    constexpr AudioFunction(AudioFunctionInitPack pack, const DESCS&... desc) : descs(desc...) {
         char_array[3] = pack.bcd_adc & 0xff;
         char_array[4] = pack.bcd_adc >> 8;
         char_array[5] = pack.catalog;
         char_array[6] = len & 0xff;
         char_array[7] = len >> 8;
         char_array[8] = pack.controls;
-        (AppendDesc(desc),...);
     }
 
-    template<class DESC>
-    constexpr void AppendDesc(const DESC& desc) {
-        size_t desc_len = desc.len;
-        for (size_t i = 0; i < desc_len ; ++i) {
-            char_array[begin + i] = desc.char_array[i];
-        }
-        begin += desc_len;
+    template<size_t N>
+    constexpr size_t Serialize(CharArray<N>& out, size_t offset) const {
+        return SerializeNested(char_array, descs, out, offset);
     }
 };
 
@@ -211,45 +207,43 @@ struct TerminalLink {
 // 3. any @AudioStreamFormat
 // 4. any @Endpoint
 template<class... DESCS>
-struct AudioStreamInterface : public IConfigCustom, public IInterfaceAssociationCustom {
+struct AudioStreamInterface : public IConfigCustom, public IInterfaceAssociationCustom, public INestedDesc {
     static constexpr size_t len = DESC_LEN_SUMMER<DESCS...>::len + TerminalLink::len + 9 * 2;
-    CharArray<len> char_array;
-    size_t begin = 0;
+    std::tuple<Interface<>, Interface<TerminalLink, DESCS...>> descs;
 
     constexpr AudioStreamInterface(
         InterfaceInitPackClassed pack,
         TerminalLink link,
         const DESCS&... desc
-    ) {
-        Interface<> empty_interface{
-            InterfaceInitPack{
-                .interface_no = pack.interface_no,
-                .alter = 0,
-                .class_ = 1,
-                .subclass = 2,
-                .protocol = pack.protocol,
-                .str_id = pack.str_id
-            }
-        };
-        Interface<TerminalLink, DESCS...> interface{
-            InterfaceInitPack{
-                .interface_no = pack.interface_no,
-                .alter = 1,
-                .class_ = 1,
-                .subclass = 2,
-                .protocol = 0x20,
-                .str_id = pack.str_id
+    ) : descs{
+            Interface<>{
+                InterfaceInitPack{
+                    .interface_no = pack.interface_no,
+                    .alter = 0,
+                    .class_ = 1,
+                    .subclass = 2,
+                    .protocol = pack.protocol,
+                    .str_id = pack.str_id
+                }
             },
-            link,
-            desc...
-        };
-        for (size_t i = 0; i < empty_interface.len; ++i) {
-            char_array[i] = empty_interface.char_array[i];
-        }
-        begin = empty_interface.len;
-        for (size_t i = 0; i < interface.len; ++i) {
-            char_array[begin + i] = interface.char_array[i];
-        }
+            Interface<TerminalLink, DESCS...>{
+                InterfaceInitPack{
+                    .interface_no = pack.interface_no,
+                    .alter = 1,
+                    .class_ = 1,
+                    .subclass = 2,
+                    .protocol = 0x20,
+                    .str_id = pack.str_id
+                },
+                link,
+                desc...
+            }
+        } {}
+
+    template<size_t N>
+    constexpr size_t Serialize(CharArray<N>& out, size_t offset) const {
+        offset = std::get<0>(descs).Serialize(out, offset);
+        return std::get<1>(descs).Serialize(out, offset);
     }
 
     template<class... CONFIG_DESCS>
@@ -260,7 +254,7 @@ struct AudioStreamInterface : public IConfigCustom, public IInterfaceAssociation
     template<class... OTHER_DESCS>
     constexpr void OnAddToInterfaceAssociation(InterfaceAssociation<OTHER_DESCS...>& association) const {
         if (association.char_array[IInterfaceAssociation::interface_count_offset] == 0) {
-            association.char_array[IInterfaceAssociation::first_interface_offset] = char_array[IInterface::interface_no_offset];
+            association.char_array[IInterfaceAssociation::first_interface_offset] = std::get<0>(descs).char_array[IInterface::interface_no_offset];
         }
         association.char_array[IInterfaceAssociation::interface_count_offset]++;
     }
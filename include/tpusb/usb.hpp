@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <type_traits>
 #include <cstdint>
+#include <tuple>
 
 // --------------------------------------------------------------------------------
 // STANDARD USB
@@ -41,7 +42,44 @@ struct CharArray {
 };
 
 template<class DESC>
-static constexpr size_t desc_len = DESC::len;
+inline constexpr size_t desc_len = DESC::len;
+
+/*
+ * a descriptor which inherit from @INestedDesc only holds its own header in
+ * @char_array and keeps the children in @descs, the bytes will be written
+ * once into the final buffer by @Serialize when a @Config is constructed
+ * @len is still the length of the whole subtree, not of @char_array
+ *
+ * template<size_t N>
+ * constexpr size_t Serialize(CharArray<N>& out, size_t offset) const
+ *
+ * other descriptor are treated as leaf and its @char_array will be copied
+*/
+struct INestedDesc {};
+
+template<class DESC, size_t N>
+constexpr size_t SerializeDesc(const DESC& desc, CharArray<N>& out, size_t offset) {
+    if constexpr (std::is_base_of_v<INestedDesc, DESC>) {
+        return desc.Serialize(out, offset);
+    }
+    else {
+        return out.Copy(offset, desc.char_array);
+    }
+}
+
+template<size_t HEADER_LEN, class... DESCS, size_t N>
+constexpr size_t SerializeNested(
+    const CharArray<HEADER_LEN>& header,
+    const std::tuple<DESCS...>& descs,
+    CharArray<N>& out,
+    size_t offset
+) {
+    offset = out.Copy(offset, header);
+    std::apply([&](const auto&... desc) {
+        ((offset = SerializeDesc(desc, out, offset)), ...);
+    }, descs);
+    return offset;
+}
 
 template<class...DESC>
 struct DESC_LEN_SUMMER {
@@ -62,16 +100,48 @@ struct BulkInitPackLen9 {
     uint8_t sync_address;
 };
 
+/*
+ * how a service period type becomes microseconds, tpusb/interval.hpp specializes it for std::chrono::duration
+ * so usb.hpp does not need <chrono>
+ *
+ * static constexpr uint32_t Microseconds(const PERIOD& period)
+*/
+template<class PERIOD>
+struct IntervalPeriodTraits;
+
+/*
+ * bInterval of a periodic endpoint, the byte as it is or a service period
+ * a period is encoded by @Config for the speed of the config, see @EncodeInterval
+ * eg. .interval = 4, .interval = 1ms with tpusb/interval.hpp
+*/
+struct Interval {
+    uint8_t value = 0;
+    // 0 when @value is given
+    uint32_t period_us = 0;
+
+    constexpr Interval() = default;
+
+    constexpr Interval(uint8_t interval) : value(interval) {}
+
+    template<class PERIOD, size_t = sizeof(IntervalPeriodTraits<PERIOD>)>
+    constexpr Interval(const PERIOD& period)
+        : period_us(IntervalPeriodTraits<PERIOD>::Microseconds(period)) {
+        if (period_us == 0) {
+            throw "service period is shorter than a microframe";
+        }
+    }
+};
+
 struct InterruptInitPack {
     uint8_t address;
     uint16_t max_pack_size;
-    uint8_t interval;
+    Interval interval;
 };
 
 struct InterruptInitPackLen9 {
     uint8_t address;
     uint16_t max_pack_size;
-    uint8_t interval;
+    Interval interval;
     uint8_t refresh;
     uint8_t sync_address;
 };
@@ -92,7 +162,7 @@ enum class IsoEpType {
 struct IsochronousInitPack {
     uint8_t address;
     uint16_t max_pack_size;
-    uint8_t interval;
+    Interval interval;
     SynchronousType sync_type;
     IsoEpType endpoint_type;
 };
@@ -100,7 +170,7 @@ struct IsochronousInitPack {
 struct IsochronousInitPackLen9 {
     uint8_t address;
     uint16_t max_pack_size;
-    uint8_t interval;
+    Interval interval;
     SynchronousType sync_type;
     IsoEpType endpoint_type;
     uint8_t refresh;
@@ -121,6 +191,184 @@ struct ControlInitPackLen9 {
     uint8_t sync_address;
 };
 
+// high speed only, up to 3 transactions per microframe
+// $bytes_per_microframe is split into wMaxPacketSize and the additional transactions, see @EncodeHighBandwidth
+struct HighBandwidthInterruptInitPack {
+    uint8_t address;
+    uint16_t bytes_per_microframe;
+    Interval interval;
+};
+
+struct HighBandwidthIsochronousInitPack {
+    uint8_t address;
+    uint16_t bytes_per_microframe;
+    Interval interval;
+    SynchronousType sync_type;
+    IsoEpType endpoint_type;
+};
+
+enum class TransferType {
+    Control = 0,
+    Isochronous = 1,
+    Bulk = 2,
+    Interrupt = 3
+};
+
+enum class Speed {
+    Full,
+    High,
+    Super
+};
+
+// the largest legal wMaxPacketSize of a transfer type at a speed
+constexpr uint16_t MaxPacketSizeLimit(TransferType type, Speed speed) {
+    switch (type) {
+    case TransferType::Control:
+        return speed == Speed::Super ? 512 : 64;
+    case TransferType::Isochronous:
+        return speed == Speed::Full ? 1023 : 1024;
+    case TransferType::Bulk:
+        return speed == Speed::Full ? 64 : speed == Speed::High ? 512 : 1024;
+    case TransferType::Interrupt:
+        return speed == Speed::Full ? 64 : 1024;
+    }
+    return 0;
+}
+
+// full speed control and bulk take 8, 16, 32 or 64, high speed bulk only 512,
+// every other size up to @MaxPacketSizeLimit is legal
+constexpr bool LegalMaxPacketSize(TransferType type, Speed speed, uint16_t size) {
+    if (speed == Speed::Full && (type == TransferType::Control || type == TransferType::Bulk)) {
+        return size == 8 || size == 16 || size == 32 || size == 64;
+    }
+    if (speed == Speed::High && type == TransferType::Bulk) {
+        return size == 512;
+    }
+    return true;
+}
+
+// bInterval of the longest service period not above $period_us microseconds
+constexpr uint8_t EncodeInterval(TransferType type, Speed speed, uint32_t period_us) {
+    int64_t us = period_us;
+    if (type != TransferType::Interrupt && type != TransferType::Isochronous) {
+        throw "only interrupt and isochronous endpoint have a service period";
+    }
+    if (speed == Speed::Full && type == TransferType::Interrupt) {
+        if (us < 1000) {
+            throw "full speed service period is at least 1ms";
+        }
+        return us / 1000 > 255 ? 255 : static_cast<uint8_t>(us / 1000);
+    }
+    int64_t unit = speed == Speed::Full ? 1000 : 125;
+    if (us < unit) {
+        throw "service period is shorter than a (micro)frame";
+    }
+    uint8_t interval = 1;
+    while (interval < 16 && (unit << interval) <= us) {
+        ++interval;
+    }
+    return interval;
+}
+
+/*
+ * tells the endpoint generator which transfer type and descriptor length
+ * a init pack is for, specialize it to add your own init pack
+ *
+ * static constexpr TransferType type
+ * static constexpr size_t len
+*/
+template<class PACK>
+struct EndpointPackTraits;
+
+template<> struct EndpointPackTraits<BulkInitPack> {
+    static constexpr TransferType type = TransferType::Bulk;
+    static constexpr size_t len = 7;
+};
+template<> struct EndpointPackTraits<BulkInitPackLen9> {
+    static constexpr TransferType type = TransferType::Bulk;
+    static constexpr size_t len = 9;
+};
+template<> struct EndpointPackTraits<InterruptInitPack> {
+    static constexpr TransferType type = TransferType::Interrupt;
+    static constexpr size_t len = 7;
+};
+template<> struct EndpointPackTraits<InterruptInitPackLen9> {
+    static constexpr TransferType type = TransferType::Interrupt;
+    static constexpr size_t len = 9;
+};
+template<> struct EndpointPackTraits<IsochronousInitPack> {
+    static constexpr TransferType type = TransferType::Isochronous;
+    static constexpr size_t len = 7;
+};
+template<> struct EndpointPackTraits<IsochronousInitPackLen9> {
+    static constexpr TransferType type = TransferType::Isochronous;
+    static constexpr size_t len = 9;
+};
+template<> struct EndpointPackTraits<ControlInitPack> {
+    static constexpr TransferType type = TransferType::Control;
+    static constexpr size_t len = 7;
+};
+template<> struct EndpointPackTraits<ControlInitPackLen9> {
+    static constexpr TransferType type = TransferType::Control;
+    static constexpr size_t len = 9;
+};
+
+template<> struct EndpointPackTraits<HighBandwidthInterruptInitPack> {
+    static constexpr TransferType type = TransferType::Interrupt;
+    static constexpr size_t len = 7;
+};
+template<> struct EndpointPackTraits<HighBandwidthIsochronousInitPack> {
+    static constexpr TransferType type = TransferType::Isochronous;
+    static constexpr size_t len = 7;
+};
+
+// wMaxPacketSize of the fewest transactions carrying $bytes_per_microframe, bits 11-12 are the additional ones
+constexpr uint16_t EncodeHighBandwidth(uint16_t bytes_per_microframe) {
+    if (bytes_per_microframe == 0 || bytes_per_microframe > 3 * 1024) {
+        throw "high bandwidth endpoint carries 1 to 3072 bytes per microframe";
+    }
+    uint16_t transactions = (bytes_per_microframe + 1023) / 1024;
+    uint16_t max_pack_size = (bytes_per_microframe + transactions - 1) / transactions;
+    return max_pack_size | ((transactions - 1) << 11);
+}
+
+// the wMaxPacketSize field of a init pack
+template<class PACK>
+constexpr uint16_t EndpointMaxPackSize(const PACK& pack) {
+    return pack.max_pack_size;
+}
+constexpr uint16_t EndpointMaxPackSize(const HighBandwidthInterruptInitPack& pack) {
+    return EncodeHighBandwidth(pack.bytes_per_microframe);
+}
+constexpr uint16_t EndpointMaxPackSize(const HighBandwidthIsochronousInitPack& pack) {
+    return EncodeHighBandwidth(pack.bytes_per_microframe);
+}
+
+// the service period of a init pack in microseconds, 0 when it gives bInterval as it is
+template<class PACK>
+constexpr uint32_t EndpointServicePeriod(const PACK& pack) {
+    if constexpr (std::is_same_v<decltype(pack.interval), Interval>) {
+        return pack.interval.period_us;
+    }
+    else {
+        return 0;
+    }
+}
+
+// the bInterval field of a init pack, a service period is encoded for high speed until @Config encodes it for its own
+template<class PACK>
+constexpr uint8_t EndpointInterval(const PACK& pack) {
+    if constexpr (std::is_same_v<decltype(pack.interval), Interval>) {
+        if (pack.interval.period_us != 0) {
+            return EncodeInterval(EndpointPackTraits<PACK>::type, Speed::High, pack.interval.period_us);
+        }
+        return pack.interval.value;
+    }
+    else {
+        return pack.interval;
+    }
+}
+
 struct IEndpoint {
     static constexpr size_t len_offset = 0;
     static constexpr size_t desc_type_offset = 1;
@@ -132,121 +380,109 @@ struct IEndpoint {
     static constexpr size_t refresh_offset = 7;
     static constexpr size_t sync_address_offset = 8;
 };
-template<class... DESCS>
-struct Endpoint : public IEndpoint {
-    static constexpr size_t len = DESC_LEN_SUMMER<DESCS...>::len + 7;
-    CharArray<len> char_array {
-        7,
-        5,
-    };
-    size_t begin = 7;
 
-    constexpr Endpoint(BulkInitPack pack, const DESCS&... decs) {
-        char_array[2] = pack.address;
-        char_array[3] = 0x02;
-        char_array[4] = pack.max_pack_size & 0xff;
-        char_array[5] = pack.max_pack_size >> 8;
-        char_array[6] = pack.interval;
-        (AppendDesc(decs),...);
-    }
+// the endpoint generator of every transfer type and descriptor length
+template<size_t HEADER_LEN, class PACK>
+constexpr CharArray<HEADER_LEN> MakeEndpointHeader(const PACK& pack) {
+    using Traits = EndpointPackTraits<PACK>;
+    static_assert(Traits::len == HEADER_LEN, "use @Endpoint for 7 bytes init pack and @EndpointLen9 for 9 bytes init pack");
+    constexpr TransferType type = Traits::type;
 
-    constexpr Endpoint(InterruptInitPack pack, const DESCS&... decs) {
-        char_array[2] = pack.address;
-        char_array[3] = 0x03;
-        char_array[4] = pack.max_pack_size & 0xff;
-        char_array[5] = pack.max_pack_size >> 8;
-        char_array[6] = pack.interval;
-        (AppendDesc(decs),...);
+    CharArray<HEADER_LEN> header {
+        HEADER_LEN,
+        5
+    };
+    header[IEndpoint::address_offset] = pack.address;
+    header[IEndpoint::attribute_offset] = static_cast<uint8_t>(type);
+    if constexpr (type == TransferType::Isochronous) {
+        header[IEndpoint::attribute_offset] |= (static_cast<uint8_t>(pack.sync_type) << 2) | (static_cast<uint8_t>(pack.endpoint_type) << 4);
     }
-
-    constexpr Endpoint(IsochronousInitPack pack, const DESCS&... decs) {
-        char_array[2] = pack.address;
-        char_array[3] = 0x01 | (static_cast<uint8_t>(pack.sync_type) << 2) | (static_cast<uint8_t>(pack.endpoint_type) << 4);
-        char_array[4] = pack.max_pack_size & 0xff;
-        char_array[5] = pack.max_pack_size >> 8;
-        char_array[6] = pack.interval;
-        (AppendDesc(decs),...);
+    uint16_t max_pack_size = EndpointMaxPackSize(pack);
+    header[IEndpoint::max_pack_low_offset] = max_pack_size & 0xff;
+    header[IEndpoint::max_pack_high_offset] = max_pack_size >> 8;
+    header[IEndpoint::interval_offset] = EndpointInterval(pack);
+    if constexpr (HEADER_LEN == 9) {
+        header[IEndpoint::refresh_offset] = pack.refresh;
+        header[IEndpoint::sync_address_offset] = pack.sync_address;
     }
 
-    constexpr Endpoint(ControlInitPack pack, const DESCS&... decs) {
-        char_array[2] = pack.address;
-        char_array[3] = 0;
-        char_array[4] = pack.max_pack_size & 0xff;
-        char_array[5] = pack.max_pack_size >> 8;
-        char_array[6] = pack.interval;
-        (AppendDesc(decs),...);
+    // the speed is only known by @Config, here check the limit of the fastest one
+    if ((max_pack_size & 0x7ff) > MaxPacketSizeLimit(type, Speed::Super)) {
+        throw "max_pack_size is too large for the transfer type";
     }
-
-    template<class DESC>
-    constexpr void AppendDesc(const DESC& desc) {
-        size_t desc_len = desc.len;
-        for (size_t i = 0; i < desc_len ; ++i) {
-            char_array[begin + i] = desc.char_array[i];
-        }
-        begin += desc_len;
+    return header;
+}
+
+template<size_t HEADER_LEN, class... DESCS>
+struct BasicEndpoint : public IEndpoint, public INestedDesc {
+    static constexpr size_t header_len = HEADER_LEN;
+    static constexpr size_t len = DESC_LEN_SUMMER<DESCS...>::len + header_len;
+    CharArray<header_len> char_array;
+    std::tuple<DESCS...> descs;
+    // see @EndpointServicePeriod
+    uint32_t period_us;
+
+    template<class PACK>
+    constexpr BasicEndpoint(const PACK& pack, const DESCS&... desc)
+        : char_array(MakeEndpointHeader<HEADER_LEN>(pack))
+        , descs(desc...)
+        , period_us(EndpointServicePeriod(pack)) {}
+
+    template<size_t N>
+    constexpr size_t Serialize(CharArray<N>& out, size_t offset) const {
+        return SerializeNested(char_array, descs, out, offset);
     }
 };
 
+// 1. one @BulkInitPack, @InterruptInitPack, @IsochronousInitPack or @ControlInitPack
+// 2. any class specific descriptor
 template<class... DESCS>
-struct EndpointLen9 : public IEndpoint {
-    static constexpr size_t len = DESC_LEN_SUMMER<DESCS...>::len + 9;
+struct Endpoint : public BasicEndpoint<7, DESCS...> {
+    template<class PACK>
+    constexpr Endpoint(const PACK& pack, const DESCS&... desc)
+        : BasicEndpoint<7, DESCS...>(pack, desc...) {}
+};
+
+// 1. one @BulkInitPackLen9, @InterruptInitPackLen9, @IsochronousInitPackLen9 or @ControlInitPackLen9
+// 2. any class specific descriptor
+template<class... DESCS>
+struct EndpointLen9 : public BasicEndpoint<9, DESCS...> {
+    template<class PACK>
+    constexpr EndpointLen9(const PACK& pack, const DESCS&... desc)
+        : BasicEndpoint<9, DESCS...>(pack, desc...) {}
+};
+
+// bmAttributes of a @SuperSpeedCompanion: bulk has up to 2^16 streams, isochronous a mult up to 2,
+// control and interrupt have none
+constexpr bool LegalCompanionAttribute(TransferType type, uint8_t attribute) {
+    switch (type) {
+    case TransferType::Bulk:
+        return attribute <= 16;
+    case TransferType::Isochronous:
+        return attribute <= 2;
+    default:
+        return attribute == 0;
+    }
+}
+
+// follows every endpoint of a super speed config, see @MakeSuperSpeedConfig
+struct SuperSpeedCompanion {
+    static constexpr size_t len = 6;
     CharArray<len> char_array {
-        9,
-        5,
+        len,
+        0x30
     };
-    size_t begin = 9;
-
-    constexpr EndpointLen9(BulkInitPackLen9 pack, const DESCS&... decs) {
-        char_array[2] = pack.address;
-        char_array[3] = 0x02;
-        char_array[4] = pack.max_pack_size & 0xff;
-        char_array[5] = pack.max_pack_size >> 8;
-        char_array[6] = pack.interval;
-        char_array[IEndpoint::refresh_offset] = pack.refresh;
-        char_array[IEndpoint::sync_address_offset] = pack.sync_address;
-        (AppendDesc(decs),...);
-    }
-
-    constexpr EndpointLen9(InterruptInitPackLen9 pack, const DESCS&... decs) {
-        char_array[2] = pack.address;
-        char_array[3] = 0x03;
-        char_array[4] = pack.max_pack_size & 0xff;
-        char_array[5] = pack.max_pack_size >> 8;
-        char_array[6] = pack.interval;
-        char_array[IEndpoint::refresh_offset] = pack.refresh;
-        char_array[IEndpoint::sync_address_offset] = pack.sync_address;
-        (AppendDesc(decs),...);
-    }
-
-    constexpr EndpointLen9(IsochronousInitPackLen9 pack, const DESCS&... decs) {
-        char_array[2] = pack.address;
-        char_array[3] = 0x01 | (static_cast<uint8_t>(pack.sync_type) << 2) | (static_cast<uint8_t>(pack.endpoint_type) << 4);
-        char_array[4] = pack.max_pack_size & 0xff;
-        char_array[5] = pack.max_pack_size >> 8;
-        char_array[6] = pack.interval;
-        char_array[IEndpoint::refresh_offset] = pack.refresh;
-        char_array[IEndpoint::sync_address_offset] = pack.sync_address;
-        (AppendDesc(decs),...);
-    }
-
-    constexpr EndpointLen9(ControlInitPackLen9 pack, const DESCS&... decs) {
-        char_array[2] = pack.address;
-        char_array[3] = 0;
-        char_array[4] = pack.max_pack_size & 0xff;
-        char_array[5] = pack.max_pack_size >> 8;
-        char_array[6] = pack.interval;
-        char_array[IEndpoint::refresh_offset] = pack.refresh;
-        char_array[IEndpoint::sync_address_offset] = pack.sync_address;
-        (AppendDesc(decs),...);
-    }
 
-    template<class DESC>
-    constexpr void AppendDesc(const DESC& desc) {
-        size_t desc_len = desc.len;
-        for (size_t i = 0; i < desc_len ; ++i) {
-            char_array[begin + i] = desc.char_array[i];
+    // $attribute is the max streams of bulk, or the mult of isochronous, see @LegalCompanionAttribute
+    // a nested companion is checked against its endpoint by @Config
+    constexpr SuperSpeedCompanion(uint8_t max_burst, uint8_t attribute, uint16_t bytes_per_interval) {
+        if (max_burst > 15) {
+            throw "max_burst is up to 15";
         }
-        begin += desc_len;
+        char_array[2] = max_burst;
+        char_array[3] = attribute;
+        char_array[4] = bytes_per_interval & 0xff;
+        char_array[5] = bytes_per_interval >> 8;
     }
 };
 
@@ -288,15 +524,16 @@ struct IInterface {
 */
 struct IInterfaceCustom {};
 template<class... DESCS>
-struct Interface : public IInterface {
-    static constexpr size_t len = DESC_LEN_SUMMER<DESCS...>::len + 9;
-    CharArray<len> char_array {
-        9,
+struct Interface : public IInterface, public INestedDesc {
+    static constexpr size_t header_len = 9;
+    static constexpr size_t len = DESC_LEN_SUMMER<DESCS...>::len + header_len;
+    CharArray<header_len> char_array {
+        header_len,
         4,
     };
-    size_t begin = 9;
+    std::tuple<DESCS...> descs;
 
-    constexpr Interface(InterfaceInitPack pack, const DESCS&... descs) {
+    constexpr Interface(InterfaceInitPack pack, const DESCS&... desc) : descs(desc...) {
         char_array[2] = pack.interface_no;
         char_array[3] = pack.alter;
         char_array[4] = 0; // num endpoint
@@ -304,7 +541,7 @@ struct Interface : public IInterface {
         char_array[6] = pack.subclass;
         char_array[7] = pack.protocol;
         char_array[8] = pack.str_id;
-        (AppendDesc(descs),...);
+        (AppendDesc(desc),...);
     }
 
     template<class DESC>
@@ -315,12 +552,11 @@ struct Interface : public IInterface {
         else if constexpr (std::is_base_of_v<IInterfaceCustom, DESC>) {
             desc.OnAddToInterface(*this);
         }
+    }
 
-        size_t desc_len = desc.len;
-        for (size_t i = 0; i < desc_len ; ++i) {
-            char_array[begin + i] = desc.char_array[i];
-        }
-        begin += desc_len;
+    template<size_t N>
+    constexpr size_t Serialize(CharArray<N>& out, size_t offset) const {
+        return SerializeNested(char_array, descs, out, offset);
     }
 };
 
@@ -344,17 +580,18 @@ struct IInterfaceAssociation {
 */
 struct IInterfaceAssociationCustom {};
 template<class... DESCS>
-struct InterfaceAssociation : public IInterfaceAssociation {
-    static constexpr size_t len = DESC_LEN_SUMMER<DESCS...>::len + 8;
-    CharArray<len> char_array {
-        8,
+struct InterfaceAssociation : public IInterfaceAssociation, public INestedDesc {
+    static constexpr size_t header_len = 8;
+    static constexpr size_t len = DESC_LEN_SUMMER<DESCS...>::len + header_len;
+    CharArray<header_len> char_array {
+        header_len,
         0xb,
         0, // first interface
         0  // interface count
     };
-    size_t begin = 8;
+    std::tuple<DESCS...> descs;
 
-    constexpr InterfaceAssociation(InterfaceAssociationInitPack pack, const DESCS&... desc) {
+    constexpr InterfaceAssociation(InterfaceAssociationInitPack pack, const DESCS&... desc) : descs(desc...) {
         char_array[4] = pack.function_class;
         char_array[5] = pack.function_subclass;
         char_array[6] = pack.function_protocol;
@@ -376,20 +613,56 @@ struct InterfaceAssociation : public IInterfaceAssociation {
         else if constexpr (std::is_base_of_v<IInterfaceAssociationCustom, DESC>) {
             desc.OnAddToInterfaceAssociation(*this);
         }
+    }
 
-        size_t desc_len = desc.len;
-        for (size_t i = 0; i < desc_len ; ++i) {
-            char_array[begin + i] = desc.char_array[i];
-        }
-        begin += desc_len;
+    template<size_t N>
+    constexpr size_t Serialize(CharArray<N>& out, size_t offset) const {
+        return SerializeNested(char_array, descs, out, offset);
     }
 };
 
+namespace internal {
+
+template<class DESC, class = void>
+struct HasDescs : std::false_type {};
+template<class DESC>
+struct HasDescs<DESC, std::void_t<decltype(std::declval<const DESC&>().descs)>> : std::true_type {};
+
+template<class... DESCS>
+constexpr size_t ChildrenLen(const std::tuple<DESCS...>*) {
+    return (0 + ... + desc_len<DESCS>);
+}
+
+}
+
+/*
+ * calls $f(endpoint, offset) for every @BasicEndpoint under $desc, $offset is where $desc is serialized,
+ * a nested descriptor is its header followed by its @descs, returns the offset after $desc
+*/
+template<class DESC, class F>
+constexpr size_t VisitEndpoints(const DESC& desc, size_t offset, F& f) {
+    if constexpr (std::is_base_of_v<IEndpoint, DESC>) {
+        f(desc, offset);
+    }
+    else if constexpr (internal::HasDescs<DESC>::value) {
+        size_t child = offset + desc_len<DESC> - internal::ChildrenLen(static_cast<const decltype(DESC::descs)*>(nullptr));
+        std::apply([&child, &f](const auto&... d) {
+            ((child = VisitEndpoints(d, child, f)), ...);
+        }, desc.descs);
+    }
+    return offset + desc_len<DESC>;
+}
+
 struct ConfigInitPack {
     uint8_t config_no;
     uint8_t str_id;
     uint8_t attribute;
     uint8_t power;
+    // every endpoint's max_pack_size is checked against this speed and its service period encoded for it,
+    // a config also offered at full speed says Speed::Full
+    Speed speed = Speed::High;
+    // endpoints may use the @auto_in and @auto_out placeholders, pass the config to @AllocateEndpointAddress
+    bool auto_address = false;
 };
 struct IConfig {
     static constexpr size_t len_offset = 0;
@@ -406,6 +679,9 @@ struct IConfig {
  * you have to inherit from @IConfigCustom
  * the copy of descriptor will be automatically merged
  *
+ * unlike the other descriptor, @Config holds the whole serialized
+ * descriptor in @char_array, every child is written into it exactly once
+ *
  * constexpr void OnAddToConfig(auto& config) const
 */
 struct IConfigCustom {};
@@ -418,7 +694,6 @@ struct Config : public IConfig {
         9,
         2
     };
-    size_t begin = 9;
 
     constexpr Config(ConfigInitPack pack, const DESCS&... desc) {
         char_array[2] = len & 0xff;
@@ -430,31 +705,81 @@ struct Config : public IConfig {
         char_array[8] = pack.power;
         (AppendDesc(desc),...);
 
+        size_t offset = 9;
+        ((offset = SerializeDesc(desc, char_array, offset)),...);
+
+        // a service period becomes bInterval of the speed of the config
+        auto encode_period = [this, speed = pack.speed](const auto& endpoint, size_t at) {
+            if (char_array[at + IEndpoint::desc_type_offset] != 5) {
+                throw "endpoint is not serialized where it is visited";
+            }
+            if (endpoint.period_us != 0) {
+                auto type = static_cast<TransferType>(char_array[at + IEndpoint::attribute_offset] & 0x3);
+                char_array[at + IEndpoint::interval_offset] = EncodeInterval(type, speed, endpoint.period_us);
+            }
+        };
+        offset = 9;
+        ((offset = VisitEndpoints(desc, offset, encode_period)),...);
+
         // check config no
         if (pack.config_no == 0) {
             throw "pack.config_no can not be 0";
         }
+        CheckEndpoints(pack.speed, pack.auto_address);
+    }
+
+    constexpr void CheckEndpoints(Speed speed, bool auto_address) const {
+        size_t offset = 0;
+        while (offset < len) {
+            size_t desc_len = char_array[offset];
+            if (desc_len == 0) {
+                throw "zero length descriptor";
+            }
+            if (char_array[offset + IEndpoint::desc_type_offset] == 5) {
+                if (!auto_address && (char_array[offset + IEndpoint::address_offset] & 0xf) == 0) {
+                    throw "endpoint number 0 is a placeholder, set auto_address and use AllocateEndpointAddress";
+                }
+                auto type = static_cast<TransferType>(char_array[offset + IEndpoint::attribute_offset] & 0x3);
+                uint16_t max_pack_size = char_array[offset + IEndpoint::max_pack_low_offset]
+                    | (char_array[offset + IEndpoint::max_pack_high_offset] << 8);
+                uint16_t additional = (max_pack_size >> 11) & 0x3;
+                if ((max_pack_size & 0x7ff) > MaxPacketSizeLimit(type, speed)) {
+                    throw "max_pack_size is too large for the speed";
+                }
+                if (!LegalMaxPacketSize(type, speed, max_pack_size & 0x7ff)) {
+                    throw "max_pack_size is not one the speed allows for the transfer type";
+                }
+                if (additional != 0 && (speed != Speed::High
+                    || type == TransferType::Control || type == TransferType::Bulk)) {
+                    throw "only high speed interrupt and isochronous endpoint can be high bandwidth";
+                }
+                if (additional == 3 || (additional == 1 && (max_pack_size & 0x7ff) < 513)
+                    || (additional == 2 && (max_pack_size & 0x7ff) < 683)) {
+                    throw "invalid additional transactions for the max_pack_size";
+                }
+                size_t next = offset + desc_len;
+                if (next + 3 < len && char_array[next + 1] == 0x30
+                    && !LegalCompanionAttribute(type, char_array[next + 3])) {
+                    throw "companion bmAttributes is not legal for the transfer type";
+                }
+            }
+            offset += desc_len;
+        }
     }
 
     template<class DESC>
     constexpr void AppendDesc(const DESC& desc) {
         if constexpr (std::is_base_of_v<IInterface, DESC>) {
-            if (desc.char_array[3] == 0) {
+            if (desc.char_array[IInterface::alter_offset] == 0) {
                 char_array[4]++;
             }
         }
         else if constexpr (std::is_base_of_v<IInterfaceAssociation, DESC>) {
-            char_array[4] += desc.char_array[3];
+            char_array[4] += desc.char_array[IInterfaceAssociation::interface_count_offset];
         }
         else if constexpr (std::is_base_of_v<IConfigCustom, DESC>) {
             desc.OnAddToConfig(*this);
         }
-
-        size_t desc_len = desc.len;
-        for (size_t i = 0; i < desc_len ; ++i) {
-            char_array[begin + i] = desc.char_array[i];
-        }
-        begin += desc_len;
     }
 };
 
@@ -473,3 +798,34 @@ struct CustomDesc {
     }
 };
 
+
+// --------------------------------------------------------------------------------
+// FINALIZE
+// --------------------------------------------------------------------------------
+
+/*
+ * copy only the bytes of any descriptor (@Config, @USBString, @Interface ...)
+ * the result holds nothing but uint8_t[DESC::len], no builder state,
+ * so it has the same size and layout as a plain byte array
+*/
+template<class DESC>
+constexpr CharArray<DESC::len> Finalize(const DESC& desc) {
+    CharArray<DESC::len> out{};
+    SerializeDesc(desc, out, 0);
+    return out;
+}
+
+#if defined(__GNUC__)
+#define TPUSB_PLACE(SECTION, ALIGN) __attribute__((section(SECTION), aligned(ALIGN), used))
+#else
+#define TPUSB_PLACE(SECTION, ALIGN) alignas(ALIGN)
+#endif
+
+/*
+ * define $NAME, the finalized bytes of $DESC aligned to $ALIGN in $SECTION
+ * C code can use it as `extern const uint8_t NAME[N];`
+ * eg. TPUSB_FINALIZED_DESCRIPTOR(usb_config, config, ".usb_desc", 4);
+*/
+#define TPUSB_FINALIZED_DESCRIPTOR(NAME, DESC, SECTION, ALIGN)\
+    extern "C" TPUSB_PLACE(SECTION, ALIGN) constexpr \
+    CharArray<std::remove_cv_t<std::remove_reference_t<decltype(DESC)>>::len> NAME = Finalize(DESC)
@@ -1,110 +1,410 @@
 #pragma once
 #include "usb.hpp"
 
+template<size_t N>
+struct USBString {
+    static constexpr size_t len = N;
+    CharArray<N> char_array;
+};
+
 namespace internal {
 
-template<class CharType, size_t len, const CharType (&str)[len]>
-struct CompileTimeUtf8ToUnicodeLength {
-    template<size_t counter, size_t offset>
-    static constexpr size_t GetUnicodeLength2() {
-        if constexpr (offset == len) {
-            return counter - 1;
-        }
-        else if constexpr (offset > len) {
-            throw "not utf8";
-            return counter;
-        }
-        else if constexpr ((str[offset] & 0x80) == 0) {
-            // 1-byte UTF-8 character (ASCII)
-            return GetUnicodeLength2<counter + 1, offset + 1>();
-        } else if constexpr ((str[offset] & 0xE0) == 0xC0) {
-            // 2-byte UTF-8 character
-            return GetUnicodeLength2<counter + 1, offset + 2>();
-        } else if constexpr ((str[offset] & 0xF0) == 0xE0) {
-            // 3-byte UTF-8 character
-            return GetUnicodeLength2<counter + 1, offset + 3>();
-        } else if constexpr ((str[offset] & 0xF8) == 0xF0) {
-            // 4-byte UTF-8 character
-            return GetUnicodeLength2<counter + 1, offset + 4>();
-        } else {
-            // Invalid UTF-8 start byte
-            throw "not utf8";
-            return counter;
-        }
-    }
-
-    static constexpr size_t GetUnicodeLength() {
-        return GetUnicodeLength2<0, 0>();
+// decode one utf8 character at $pos into $code and move $pos to the next one
+// false for a truncated or overlong sequence, a surrogate or a code above U+10FFFF
+template<class CharType>
+constexpr bool TryDecodeUtf8(const CharType* str, size_t size, size_t& pos, uint32_t& code) {
+    auto c = static_cast<uint8_t>(str[pos]);
+    size_t num_bytes = 0;
+    // the smallest code which needs $num_bytes
+    uint32_t min_code = 0;
+
+    if ((c & 0x80) == 0) {
+        // 1-byte UTF-8 character (ASCII)
+        num_bytes = 1;
+        code = c;
+    } else if ((c & 0xE0) == 0xC0) {
+        // 2-byte UTF-8 character
+        num_bytes = 2;
+        code = c & 0x1F;
+        min_code = 0x80;
+    } else if ((c & 0xF0) == 0xE0) {
+        // 3-byte UTF-8 character
+        num_bytes = 3;
+        code = c & 0x0F;
+        min_code = 0x800;
+    } else if ((c & 0xF8) == 0xF0) {
+        // 4-byte UTF-8 character
+        num_bytes = 4;
+        code = c & 0x07;
+        min_code = 0x10000;
+    } else {
+        // Invalid UTF-8 start byte
+        return false;
+    }
+
+    if (pos + num_bytes > size) {
+        return false;
+    }
+    for (size_t i = 1; i < num_bytes; ++i) {
+        auto next = static_cast<uint8_t>(str[pos + i]);
+        if ((next & 0xC0) != 0x80) {
+            return false;
+        }
+        code = (code << 6) | (next & 0x3F);
+    }
+    if (code < min_code || code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF)) {
+        return false;
+    }
+
+    pos += num_bytes;
+    return true;
+}
+
+template<class CharType>
+constexpr uint32_t DecodeUtf8(const CharType* str, size_t size, size_t& pos) {
+    uint32_t code = 0;
+    if (!TryDecodeUtf8(str, size, pos, code)) {
+        throw "not utf8";
+    }
+    return code;
+}
+
+// $size is the number of CharType including the ending '\0'
+template<class CharType>
+constexpr bool IsUtf8(const CharType* str, size_t size) {
+    size_t pos = 0;
+    uint32_t code = 0;
+    while (pos < size - 1) {
+        if (!TryDecodeUtf8(str, size - 1, pos, code)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// $size is the number of CharType including the ending '\0'
+// return the number of utf16 code unit, code point above U+FFFF takes 2
+template<class CharType>
+constexpr size_t GetUnicodeLength(const CharType* str, size_t size) {
+    size_t pos = 0;
+    size_t counter = 0;
+    while (pos < size - 1) {
+        uint32_t code = DecodeUtf8(str, size - 1, pos);
+        counter += code > 0xFFFF ? 2 : 1;
+    }
+    return counter;
+}
+
+// write the utf16le string after the 2 bytes header of $out
+template<class CharType, size_t N>
+constexpr void Utf8ToUnicode(const CharType* str, size_t size, CharArray<N>& out) {
+    size_t pos = 0;
+    size_t wpos = 2;
+    while (pos < size - 1) {
+        uint32_t code = DecodeUtf8(str, size - 1, pos);
+        if (code > 0xFFFF) {
+            // surrogate pair
+            code -= 0x10000;
+            uint16_t high = 0xD800 | (code >> 10);
+            uint16_t low = 0xDC00 | (code & 0x3FF);
+            out[wpos++] = high & 0xff;
+            out[wpos++] = high >> 8;
+            out[wpos++] = low & 0xff;
+            out[wpos++] = low >> 8;
+        }
+        else {
+            out[wpos++] = code & 0xff;
+            out[wpos++] = code >> 8;
+        }
+    }
+}
+
+// STR is a type which have a static constexpr function Get() returning the string literal
+// only one template will be instantiated for each string whatever its length is
+template<class STR>
+constexpr auto CompileTimeUtf8ToUnicode() {
+    constexpr size_t size = sizeof(STR::Get()) / sizeof(STR::Get()[0]);
+    constexpr size_t len = GetUnicodeLength(STR::Get(), size) * 2 + 2;
+    static_assert(len <= 0xff, "string descriptor too long");
+
+    USBString<len> str{
+        CharArray<len>{
+            len,
+            3
+        }
+    };
+    Utf8ToUnicode(STR::Get(), size, str.char_array);
+    return str;
+}
+
+}
+
+#if __cplusplus >= 202002L
+namespace internal {
+
+template<class CharType, size_t N>
+struct FixedString {
+    static constexpr size_t size = N;
+    CharType str[N]{};
+
+    consteval FixedString(const CharType (&init)[N]) {
+        for (size_t i = 0; i < N; ++i) {
+            str[i] = init[i];
+        }
     }
 };
 
-template<class CharType, size_t size, const CharType (&str)[size]>
-struct CompileTimeUtf8ToUnicode {
-    static constexpr size_t len = CompileTimeUtf8ToUnicodeLength<CharType, size, str>::GetUnicodeLength() * 2 + 2;
-    CharArray<len> char_array {
-        len,
-        3
+template<FixedString STR>
+consteval auto FixedStringToUnicode() {
+    constexpr size_t len = GetUnicodeLength(STR.str, STR.size) * 2 + 2;
+    static_assert(len <= 0xff, "string descriptor too long");
+
+    USBString<len> str{
+        CharArray<len>{
+            len,
+            3
+        }
     };
+    Utf8ToUnicode(STR.str, STR.size, str.char_array);
+    return str;
+}
 
-    constexpr CompileTimeUtf8ToUnicode() {
-        size_t pos = 0;
-        size_t wpos = 0;
-
-        while (pos < size - 1) {
-            uint32_t code = 0;
-            auto c = str[pos];
-
-            if ((c & 0x80) == 0) {
-                // 1-byte UTF-8 character (ASCII)
-                code = c;
-                pos += 1;
-            } else if ((c & 0xE0) == 0xC0) {
-                // 2-byte UTF-8 character
-                code = ((c & 0x1F) << 6) | ((str[pos + 1]) & 0x3F);
-                pos += 2;
-            } else if ((c & 0xF0) == 0xE0) {
-                // 3-byte UTF-8 character
-                code = ((c & 0x0F) << 12) | (((str[pos + 1]) & 0x3F) << 6) | ((str[pos + 2]) & 0x3F);
-                pos += 3;
-            } else if ((c & 0xF8) == 0xF0) {
-                // 4-byte UTF-8 character
-                code = ((c & 0x07) << 18) | (((str[pos + 1]) & 0x3F) << 12) | (((str[pos + 2]) & 0x3F) << 6) | ((str[pos + 3]) & 0x3F);
-                pos += 4;
-            } else {
-                // Invalid UTF-8 start byte
-                throw "not utf8";
-            }
+}
+
+// c++20 only, eg. usb_string<u8"wch.cn">
+// the same literal is always the same type and the same object in the whole program
+template<internal::FixedString STR>
+inline constexpr auto usb_string = internal::FixedStringToUnicode<STR>();
+#endif
+
+// c++17 compatible, every use is a distinct type
+#define USB_STR(STR)\
+    []{\
+        struct Str {\
+            static constexpr decltype(auto) Get() { return STR; }\
+        };\
+        return internal::CompileTimeUtf8ToUnicode<Str>();\
+    }()
+
+// --------------------------------------------------------------------------------
+// PACKED STRING
+// an ascii only string keeps 1 byte per character in flash and is widened to utf16 by @Read,
+// any other string falls back to the whole utf16 descriptor
+// --------------------------------------------------------------------------------
 
-            char_array[2 + wpos * 2] = code & 0xff;
-            char_array[2 + wpos * 2 + 1] = code >> 8;
-            ++wpos;
+// $LEN is bLength of the descriptor on the bus, $STORAGE_LEN the bytes in flash
+template<size_t LEN, size_t STORAGE_LEN, bool ASCII>
+struct PackedUSBString {
+    static constexpr size_t len = LEN;
+    static constexpr size_t storage_len = STORAGE_LEN;
+    static constexpr bool ascii = ASCII;
+    uint8_t storage[STORAGE_LEN > 0 ? STORAGE_LEN : 1]{};
+
+    // the $i th byte of the descriptor
+    constexpr uint8_t operator[](size_t i) const {
+        if constexpr (ASCII) {
+            if (i < 2) {
+                return i == 0 ? static_cast<uint8_t>(LEN) : uint8_t{3};
+            }
+            return (i & 1) == 0 ? storage[(i - 2) / 2] : uint8_t{0};
         }
+        else {
+            return storage[i];
+        }
+    }
 
-        if (pos != size - 1) {
-            throw "not utf8";
+    // copy up to $n bytes of the descriptor from $offset, return the number copied
+    constexpr size_t Read(size_t offset, uint8_t* out, size_t n) const {
+        size_t count = 0;
+        for (; count < n && offset + count < LEN; ++count) {
+            out[count] = (*this)[offset + count];
         }
-        
+        return count;
     }
 };
 
+namespace internal {
+
+// $N is the number of CharType including the ending '\0'
+template<size_t N, class CharType, size_t LEN>
+constexpr auto Pack(const CharType* str, const USBString<LEN>& unicode) {
+    if constexpr (N - 1 + N - 1 + 2 == LEN && LEN != 0) {
+        // every character took one utf16 code unit, so the string is ascii
+        PackedUSBString<LEN, N - 1, true> packed{};
+        for (size_t i = 0; i + 1 < N; ++i) {
+            packed.storage[i] = static_cast<uint8_t>(str[i]);
+        }
+        return packed;
+    }
+    else {
+        PackedUSBString<LEN, LEN, false> packed{};
+        for (size_t i = 0; i < LEN; ++i) {
+            packed.storage[i] = unicode.char_array[i];
+        }
+        return packed;
+    }
 }
 
-template<size_t N>
-struct USBString {
-    static constexpr size_t len = N;
-    CharArray<N> char_array;
-};
+template<class STR>
+constexpr auto CompileTimePack() {
+    constexpr size_t size = sizeof(STR::Get()) / sizeof(STR::Get()[0]);
+    return Pack<size>(STR::Get(), CompileTimeUtf8ToUnicode<STR>());
+}
+
+}
 
 #if __cplusplus >= 202002L
-#define USB_STR(STR)\
-    []{\
-        static constexpr char str[] = STR;\
-        return internal::CompileTimeUtf8ToUnicode<char8_t, sizeof(str), str>{};\
-    }();
-#else
-#define USB_STR(STR)\
+// c++20 only, eg. usb_packed_string<u8"wch.cn">
+template<internal::FixedString STR>
+inline constexpr auto usb_packed_string = internal::Pack<STR.size>(STR.str, usb_string<STR>);
+#endif
+
+// like @USB_STR, stores ascii strings packed
+#define USB_STR_PACKED(STR)\
     []{\
-        static constexpr char str[] = STR;\
-        return internal::CompileTimeUtf8ToUnicode<char, sizeof(str), str>{};\
+        struct Str {\
+            static constexpr decltype(auto) Get() { return STR; }\
+        };\
+        return internal::CompileTimePack<Str>();\
+    }()
+
+// --------------------------------------------------------------------------------
+// STRING TABLE
+// write the config as a lambda taking a string resolver, every str_id field can take a string then
+//
+// static constexpr auto make_config = [](auto& str) { return Config{ConfigInitPack{1, str(u8"Default"), 0x80, 50}, ...}; };
+// static constexpr auto strings = MakeStringTable(make_config);
+// static constexpr auto config = make_config(strings);
+//
+// the first run collects and deduplicates the strings, the second one gets the dense indices
+// --------------------------------------------------------------------------------
+
+namespace internal {
+
+// the utf16 code units of $str, return the number of them
+template<class CharType, size_t N>
+constexpr size_t EncodeUtf16(const CharType (&str)[N], uint16_t* out) {
+    size_t pos = 0;
+    size_t count = 0;
+    while (pos < N - 1) {
+        uint32_t code = DecodeUtf8(str, N - 1, pos);
+        if (code > 0xFFFF) {
+            code -= 0x10000;
+            out[count++] = static_cast<uint16_t>(0xD800 | (code >> 10));
+            out[count++] = static_cast<uint16_t>(0xDC00 | (code & 0x3FF));
+        }
+        else {
+            out[count++] = static_cast<uint16_t>(code);
+        }
+    }
+    return count;
+}
+
+struct StringCollector {
+    static constexpr size_t max_unit = 8192;
+    uint16_t units[max_unit]{};
+    // index 0 is the language id
+    uint16_t begin[256]{};
+    uint8_t length[256]{};
+    size_t num_string = 1;
+    size_t num_unit = 0;
+
+    // "" has no string, index 0
+    template<class CharType, size_t N>
+    constexpr uint8_t operator()(const CharType (&str)[N]) {
+        if (N <= 1) {
+            return 0;
+        }
+        if (num_unit + 2 * N > max_unit) {
+            throw "too many strings";
+        }
+        size_t count = EncodeUtf16(str, units + num_unit);
+        if (count > 126) {
+            throw "string descriptor too long";
+        }
+        for (size_t i = 1; i < num_string; ++i) {
+            bool same = length[i] == count;
+            for (size_t j = 0; same && j < count; ++j) {
+                same = units[begin[i] + j] == units[num_unit + j];
+            }
+            if (same) {
+                return static_cast<uint8_t>(i);
+            }
+        }
+        if (num_string == 256) {
+            throw "too many strings";
+        }
+        begin[num_string] = static_cast<uint16_t>(num_unit);
+        length[num_string] = static_cast<uint8_t>(count);
+        num_unit += count;
+        return static_cast<uint8_t>(num_string++);
+    }
+};
+
+}
+
+// @pool holds the string descriptors back to back, the one of index i starts at @offsets[i]
+template<size_t NUM_STRING, size_t LEN>
+struct StringTable {
+    static constexpr size_t num_string = NUM_STRING;
+    static constexpr size_t len = LEN;
+    CharArray<LEN> pool;
+    uint16_t offsets[NUM_STRING]{};
+
+    constexpr const uint8_t* Get(uint8_t index) const {
+        return pool.desc + offsets[index];
+    }
+
+    constexpr uint8_t Size(uint8_t index) const {
+        return pool[offsets[index]];
+    }
+
+    // the index of a collected string, "" is 0
+    template<class CharType, size_t N>
+    constexpr uint8_t operator()(const CharType (&str)[N]) const {
+        if (N <= 1) {
+            return 0;
+        }
+        uint16_t units[2 * N]{};
+        size_t count = internal::EncodeUtf16(str, units);
+        for (size_t i = 1; i < NUM_STRING; ++i) {
+            bool same = pool[offsets[i]] == count * 2 + 2;
+            for (size_t j = 0; same && j < count; ++j) {
+                size_t offset = offsets[i] + 2 + j * 2;
+                same = (pool[offset] | (pool[offset + 1] << 8)) == units[j];
+            }
+            if (same) {
+                return static_cast<uint8_t>(i);
+            }
+        }
+        throw "string not collected by MakeStringTable";
+    }
+};
+
+template<class MAKE>
+constexpr auto MakeStringTable(MAKE make, uint16_t lang_id = 0x0409) {
+    constexpr internal::StringCollector collector = [make] {
+        internal::StringCollector c;
+        make(c);
+        return c;
     }();
-#endif
+    constexpr size_t len = 4 + (collector.num_string - 1) * 2 + collector.num_unit * 2;
+
+    StringTable<collector.num_string, len> table{};
+    table.pool[0] = 4;
+    table.pool[1] = 3;
+    table.pool[2] = lang_id & 0xff;
+    table.pool[3] = lang_id >> 8;
+    size_t offset = 4;
+    for (size_t i = 1; i < collector.num_string; ++i) {
+        table.offsets[i] = static_cast<uint16_t>(offset);
+        table.pool[offset++] = static_cast<uint8_t>(collector.length[i] * 2 + 2);
+        table.pool[offset++] = 3;
+        for (size_t j = 0; j < collector.length[i]; ++j) {
+            uint16_t unit = collector.units[collector.begin[i] + j];
+            table.pool[offset++] = unit & 0xff;
+            table.pool[offset++] = unit >> 8;
+        }
+    }
+    return table;
+}
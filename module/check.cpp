@@ -0,0 +1,55 @@
+// compiled only by module/CMakeLists.txt, checks the module exports what the examples use
+// gcc 12 fails on std::tuple instantiated in an importer unless the importer includes <tuple> itself
+#include <tuple>
+import tpusb;
+
+static constexpr auto config =
+Config{
+    ConfigInitPack{
+        1, 0, 0x80, 250
+    },
+    InterfaceAssociation{
+        InterfaceAssociationInitPack{
+            2, 2, 1, 0
+        },
+        CDCControlInterface{
+            InterfaceInitPackClassed{
+                0, 0, 1, 0
+            },
+            FunctionDesc{
+                0x0110
+            },
+            CDCLength{
+                0, 1
+            },
+            CDCManagement{
+                2
+            },
+            CDCInterfaceSpecify{
+                0, 1
+            },
+            Endpoint{
+                InterruptInitPack{
+                    0x81, 64, 4
+                }
+            }
+        },
+        CDCDataInterface{
+            InterfaceInitPackClassed{
+                1, 0, 0, 0
+            },
+            Endpoint{
+                BulkInitPack{
+                    0x02, 512, 0
+                }
+            },
+            Endpoint{
+                BulkInitPack{
+                    0x82, 512, 0
+                }
+            }
+        }
+    }
+};
+static_assert(config.char_array[IConfig::num_interface_offset] == 2);
+static_assert(usb_string<u8"wch.cn">.len == 14);
@@ -0,0 +1,39 @@
+// --------------------------------------------------------------------------------
+// C++20 named module of the headers in include/tpusb, see module/CMakeLists.txt
+// one module unit without partitions, gcc 12 crashes in write_location on export import :partition
+// and does not export a using declaration of a name from the global module fragment,
+// so the headers are included in the purview and every name they declare is exported.
+// the standard headers stay in the global module fragment
+// --------------------------------------------------------------------------------
+module;
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+export module tpusb;
+
+// the USB_STR and USB_STR_PACKED macros are not exported, use usb_string<"..."> and usb_packed_string<"...">
+export extern "C++" {
+#include "tpusb/usb.hpp"
+#include "tpusb/usb_str.hpp"
+#include "tpusb/cdc.hpp"
+#include "tpusb/hid.hpp"
+#include "tpusb/uac2.hpp"
+#include "tpusb/midiv1.hpp"
+#include "tpusb/layout.hpp"
+#include "tpusb/device.hpp"
+#include "tpusb/msos20.hpp"
+#include "tpusb/bandwidth.hpp"
+#include "tpusb/interval.hpp"
+#include "tpusb/controller.hpp"
+#include "tpusb/address.hpp"
+#include "tpusb/buffer.hpp"
+#include "tpusb/registry.hpp"
+#include "tpusb/ep0.hpp"
+#include "tpusb/patch.hpp"
+}
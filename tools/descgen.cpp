@@ -0,0 +1,179 @@
+// host side of tpusb/descgen.hpp, linked with the descriptor TU
+// usage: descgen <output dir> <name>
+// writes <name>.c and <name>.h with every descriptor marked by TPUSB_DESCRIPTOR,
+// and <name>.json with the layout map and statistics of tpusb/layout.hpp
+#include "tpusb/descgen.hpp"
+#include "tpusb/layout.hpp"
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using tpusb::descgen::Entry;
+
+static std::string Upper(std::string s) {
+    for (auto& c : s) {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+    return s;
+}
+
+static std::string Hex(unsigned value, int width) {
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "%0*X", width, value);
+    return buf;
+}
+
+// offsets of the interfaces and endpoints inside a configuration descriptor
+static void WriteOffsets(std::ofstream& h, const Entry& entry) {
+    const std::string prefix = Upper(entry.name);
+    unsigned interface_no = 0;
+    unsigned alter = 0;
+    size_t offset = 0;
+    while (offset + 1 < entry.len && entry.data[offset] != 0) {
+        const uint8_t* desc = entry.data + offset;
+        std::string name;
+        switch (desc[1]) {
+        case 4:
+            interface_no = desc[2];
+            alter = desc[3];
+            name = prefix + "_IF" + std::to_string(interface_no) + "_ALT" + std::to_string(alter);
+            break;
+        case 5:
+            name = prefix + "_IF" + std::to_string(interface_no) + "_ALT" + std::to_string(alter)
+                + "_EP" + Hex(desc[2], 2);
+            break;
+        case 0xb:
+            name = prefix + "_IAD" + std::to_string(desc[2]);
+            break;
+        default:
+            break;
+        }
+        if (!name.empty()) {
+            h << "#define " << name << "_OFFSET " << offset << "\n";
+        }
+        offset += desc[0];
+    }
+}
+
+static const char* TransferTypeName(size_t type) {
+    static const char* names[] = {"control", "isochronous", "bulk", "interrupt"};
+    return names[type];
+}
+
+static void WriteJson(std::ofstream& json, const Entry& entry) {
+    json << "    {\n"
+         << "        \"name\": \"" << entry.name << "\",\n"
+         << "        \"length\": " << entry.len;
+    if (entry.len < 2 || entry.data[1] != 2) {
+        json << "\n    }";
+        return;
+    }
+
+    const DescriptorStats stats = MakeDescriptorStats(entry.data, entry.len);
+    json << ",\n        \"descriptors\": [";
+    bool first = true;
+    WalkDescriptors(entry.data, entry.len, [&](const DescriptorInfo& info) {
+        json << (first ? "\n" : ",\n")
+             << "            {\"offset\": " << info.offset
+             << ", \"length\": " << unsigned(info.length)
+             << ", \"type\": " << unsigned(info.type);
+        // only class specific interface and endpoint descriptors have a subtype
+        if (info.type == 0x24 || info.type == 0x25) {
+            json << ", \"subtype\": " << unsigned(info.subtype);
+        }
+        if (info.interface_no != no_interface) {
+            json << ", \"interface\": " << unsigned(info.interface_no)
+                 << ", \"alter\": " << unsigned(info.alter)
+                 << ", \"class\": " << unsigned(info.interface_class);
+        }
+        if (info.transfer_type != no_transfer_type) {
+            json << ", \"transfer_type\": \"" << TransferTypeName(info.transfer_type) << "\"";
+        }
+        json << "}";
+        first = false;
+    });
+    json << "\n        ],\n";
+
+    json << "        \"num_interface\": " << unsigned(stats.num_interface) << ",\n"
+         << "        \"num_endpoint\": " << unsigned(stats.num_endpoint) << ",\n"
+         << "        \"class_bytes\": {";
+    first = true;
+    for (size_t i = 0; i < 256; ++i) {
+        if (stats.class_bytes[i] != 0) {
+            json << (first ? "" : ", ") << "\"" << i << "\": " << stats.class_bytes[i];
+            first = false;
+        }
+    }
+    json << "},\n        \"interface_bytes\": {";
+    first = true;
+    for (size_t i = 0; i < 256; ++i) {
+        if (stats.interface_bytes[i] != 0) {
+            json << (first ? "" : ", ") << "\"" << i << "\": " << stats.interface_bytes[i];
+            first = false;
+        }
+    }
+    json << "},\n        \"transfer_types\": {";
+    for (size_t i = 0; i < 4; ++i) {
+        json << (i == 0 ? "" : ", ") << "\"" << TransferTypeName(i) << "\": {\"count\": "
+             << unsigned(stats.transfer_type_count[i]) << ", \"bytes\": " << stats.transfer_type_bytes[i] << "}";
+    }
+    json << "},\n        \"ep0_packets\": {";
+    const uint8_t max_pack_sizes[] = {8, 16, 32, 64};
+    for (size_t i = 0; i < 4; ++i) {
+        json << (i == 0 ? "" : ", ") << "\"" << unsigned(max_pack_sizes[i]) << "\": " << stats.Ep0Packets(max_pack_sizes[i]);
+    }
+    json << "}\n    }";
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::fprintf(stderr, "usage: %s <output dir> <name>\n", argv[0]);
+        return 1;
+    }
+    const std::string dir = argv[1];
+    const std::string name = argv[2];
+
+    std::ofstream h(dir + "/" + name + ".h");
+    std::ofstream c(dir + "/" + name + ".c");
+    std::ofstream json(dir + "/" + name + ".json");
+    if (!h || !c || !json) {
+        std::fprintf(stderr, "can not write %s/%s.[ch]/.json\n", dir.c_str(), name.c_str());
+        return 1;
+    }
+
+    h << "// generated by tpusb descgen, do not edit\n"
+      << "#pragma once\n"
+      << "#include <stddef.h>\n"
+      << "#include <stdint.h>\n\n"
+      << "#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n";
+    c << "// generated by tpusb descgen, do not edit\n"
+      << "#include \"" << name << ".h\"\n";
+
+    for (const Entry& entry : tpusb::descgen::Registry()) {
+        const std::string upper = Upper(entry.name);
+        h << "#define " << upper << "_LEN " << entry.len << "\n";
+        if (entry.len > 1 && entry.data[1] == 2) {
+            WriteOffsets(h, entry);
+        }
+        h << "extern const uint8_t " << entry.name << "[" << upper << "_LEN];\n\n";
+
+        c << "\nconst uint8_t " << entry.name << "[" << upper << "_LEN] = {";
+        for (size_t i = 0; i < entry.len; ++i) {
+            c << (i % 12 == 0 ? "\n    " : " ") << "0x" << Hex(entry.data[i], 2) << ",";
+        }
+        c << "\n};\n";
+    }
+
+    h << "#ifdef __cplusplus\n}\n#endif\n";
+
+    json << "[\n";
+    bool first = true;
+    for (const Entry& entry : tpusb::descgen::Registry()) {
+        json << (first ? "" : ",\n");
+        WriteJson(json, entry);
+        first = false;
+    }
+    json << "\n]\n";
+    return 0;
+}